@@ -24,11 +24,25 @@
 //
 //				Flag -l will execute the devInfo - OpenCL device query
 //
+//				Flag -a will search for the best configuration guided by the random forest,
+//				or with a genetic algorithm or simulated annealing
+//
 //				Flag -g will obtain samples to be used in the random forest
 //
-//				Flag -m will perform basic matrix multiplication on CPU on OpenCL
+//				Flag -w will sweep a search space over many shapes with no prompts
+//
+//				Flag -m will perform matrix multiplication on the CPU (packed, SIMD
+//				micro-kernels) and tune its blocking
+//
+//				Flag -s will split one multiply across every device and the CPU
+//
+//				Flag -b will run a batch of small multiplies in one launch and compare
+//				it with a launch per matrix
 //
-//				Flag -r will execute the random forest python script
+//				Flag -r will train the random forest on the samples and rank the
+//				candidate configurations for a matrix shape
+//
+//				Every measurement is also appended to the results dataset (results.cpp)
 //
 /****************************************************************************************/
 
@@ -36,16 +50,50 @@
 #include "devInfo.hpp"
 #include "host.hpp"
 #include "arg_parse.hpp"
+#include "random_forest.hpp"
+#include "tuner.hpp"
+#include "tuning_db.hpp"
+#include "roofline.hpp"
+#include "cpu_sgemm.hpp"
+#include "hetero.hpp"
+#include "sampler.hpp"
+#include "batched.hpp"
+#include "search_space.hpp"
+#include "results.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
 
 
 static const char* help =
 "Options: \n \
 -h			Display this messages and exit \n \
+-a			Search for the best configuration of one layout (NN, NT, \n \
+				TN or TT), launching only the ones the Random Forest \n \
+				expects to improve on, or with a genetic or annealing \n \
+				search, ranked by kernel or end to end (total) time, \n \
+				log the best time against launches, and exit \n \
 -g 			Obtain samples for Random Forest predictions  \n \
+-w			Sweep a search space over many shapes with no prompts, \n \
+				taking space=FILE, param=\"NAME int|pow2|list VALUES \n \
+				[when NAME=V,...]\", shapes=MxNxK,..., \n \
+				sampler=exhaustive|random|lhs, samples=N, seed=N, \n \
+				out=FILE, abort=F (stop samples F times slower than \n \
+				the fastest, 0 never) and results=NAME, and exit \n \
 -l			List all available OpenCL Devices in detail and exit \n \
--m 			Perform basic matrix multiplication on CPU no OpenCL, \n \
-				report execution time, and exit \n \
--r			Execute Random Forest Python Script and exit \n \
+-m 			Perform matrix multiplication on the CPU with no OpenCL, \n \
+				tune its blocking, report execution time, and exit \n \
+-s			Split one multiply across every OpenCL device and the CPU, \n \
+				balancing rows by measured throughput, and exit \n \
+-b			Multiply a batch of small matrices in one launch, compare it \n \
+				with one launch per matrix, and exit \n \
+-r			Train the Random Forest on the samples, report its score \n \
+				and the best predicted configurations, and exit \n \
+\n \
+Every measurement of oclsgemm, -g, -w and -a is also appended to the results \n \
+dataset NAME.jsonl and NAME.bin, named by OCLSGEMM_RESULTS (oclsgemm_results); \n \
+-r trains on NAME.bin when it exists \n \
 \n";
 
 void print_help(int argc, char** argv){
@@ -54,98 +102,296 @@ void print_help(int argc, char** argv){
 }
 
 
+// Append one pipelined sample, with its check, to the results dataset; a sample stopped
+// early was never checked
+static void append_sample(ResultsWriter& results, const char* source,
+						  const int M, const int N, const int K, const PipelineSample& sample)
+{
+	ResultRecord record = make_record(source, sample.time, M, N, K, sample.config, &sample.stats);
+	if (sample.stats.reps > 0 && !sample.stats.aborted)
+		record.verified = sample.verified.passed ? 1 : 0;
+	results.append(record);
+}
+
+
 double basic_matrix(){
 
-	int size = 0;
-	srand(2018);
+	int mtx_m = 0, mtx_n = 0, mtx_k = 0;
+	int max_launches = 0;
+	
+	std::cout << "What are the M, N and K dimensions that you want for the Matrices?: ";
+	std::cin  >> mtx_m >> mtx_n >> mtx_k;
+	std::cout << "How many CPU configurations should be tuned (0 for the default only)?: ";
+	std::cin  >> max_launches;
+	
+	// Packed CPU SGEMM with the micro-kernels of this CPU
+	CpuIsa isa = cpu_isa();
+	CpuConfig config = default_cpu_config(isa);
+	BenchmarkOptions bench = default_benchmark_options();
+	
+	printf("\nDefault configuration\n==========================\n");
+	double time = run_cpu_sgemm(mtx_m, mtx_n, mtx_k, config, isa, &bench);
+	if (time < 0){
+		return time;
+	}
+	if (max_launches <= 0){
+		print_cpu_scaling(mtx_m, mtx_n, mtx_k, config, isa, bench);
+		return time;
+	}
+	
+	// Same model-guided search as -a, over MC, NC, KC, the micro-tile, the thread
+	// count and the task grain
+	TunerOptions options = default_tuner_options();
+	options.max_launches = max_launches;
+	
+	std::string filename = "cpu_dataset.csv";
+	std::ofstream cpu_dataset;
+	cpu_dataset.open(filename);
+	write_cpu_csv_header(cpu_dataset);
+	
+	printf("\nTuning %s configurations\n==========================\n", cpu_isa_name(isa));
+	CpuTunerResult result = tune_cpu(mtx_m, mtx_n, mtx_k, isa, options, cpu_dataset);
+	cpu_dataset.close();
+	
+	printf("\nLaunched %d of %d configurations\n", result.launches, result.candidates);
+	if (result.best_time < 0){
+		std::cout << "	No configuration ran successfully!" << std::endl;
+		return time;
+	}
+	printf("Best configuration (%s):\n", cpu_isa_name(isa));
+	print_cpu_inputs(mtx_m, mtx_n, mtx_k, result.best);
+	printf("	Outputs (ms): [%.3f], %.2f GFLOP/s, %.2fx the default\n", result.best_time,
+		   sgemm_gflops(mtx_m, mtx_n, mtx_k, result.best_time), time / result.best_time);
+	print_cpu_scaling(mtx_m, mtx_n, mtx_k, result.best, isa, bench);
+	
+	std::cout << "Success! Results are saved in " << filename << "." << std::endl;
+	return result.best_time;
+	
+}
+
+void split_sgemm(int argc, char** argv){
 
-	std::cout << "Enter Data Size (1,2,4,...2048): ";
-	std::cin  >> size;
+	int mtx_m = 0, mtx_n = 0, mtx_k = 0;
+	int runs = 0;
 	
-	float** matxA = new float* [size];
-	float** matxB = new float* [size];
-	float** matxC = new float* [size];
-	for (int i = 0; i < size; i++) {
-		matxA[i] = new float[size];
-		matxB[i] = new float[size];
-		matxC[i] = new float[size];
+	std::cout << "What are the M, N and K dimensions that you want for the Matrices?: ";
+	std::cin  >> mtx_m >> mtx_n >> mtx_k;
+	std::cout << "How many times should the multiply run?: ";
+	std::cin  >> runs;
+	
+	if (mtx_m <= 0 || mtx_n <= 0 || mtx_k <= 0){
+		std::cout << "	Matrix dimensions must be positive!" << std::endl;
+		return;
 	}
 	
-	for (int i = 0; i < size; i++){
-		for (int j = 0; j < size; j++){
-			matxA[i][j] = rand()/ (float)RAND_MAX;
+	std::vector<float> A((size_t) mtx_m * mtx_k), B((size_t) mtx_k * mtx_n), C((size_t) mtx_m * mtx_n);
+	seedMatrix(&A[0], A.size());
+	seedMatrix(&B[0], B.size());
+	
+	// Every OpenCL device and the host CPU; the first run splits evenly and measures
+	// the rate of each device, later runs split by those rates
+	HeteroSgemm split;
+	VerifyOptions verify = default_verify_options(VERIFY_FREIVALDS);
+	for (int run = 0; run < runs; run++){
+		double time = split.run(mtx_m, mtx_n, mtx_k, &A[0], mtx_k, &B[0], mtx_n, &C[0], mtx_n);
+		if (time < 0){
+			std::cout << "	The split multiply failed!" << std::endl;
+			return;
+		}
+		split.print_report(mtx_m, mtx_n, mtx_k, time);
+		
+		VerifyResult verified = verify_sgemm(verify, mtx_m, mtx_n, mtx_k, &A[0], mtx_k, &B[0], mtx_n, &C[0], mtx_n);
+		if (!verified.passed){
+			printf("	The split matrix is not equal (error %.2f times the rounding bound)\n", verified.max_error);
+			return;
 		}
+		printf("	The matrices are equal! (%s check, error %.2f of the rounding bound)\n",
+			   verify_mode_name(verify.mode), verified.max_error);
 	}
+}
+
+void batched_sgemm(int argc, char** argv){
+
+	int mtx_m = 0, mtx_n = 0, mtx_k = 0;
+	int batch = 0;
 	
-	for (int i = 0; i < size; i++){
-		for (int j = 0; j < size; j++){
-			matxB[i][j] = rand()/ (float)RAND_MAX;
-		}
+	std::cout << "What are the M, N and K dimensions that you want for the Matrices?: ";
+	std::cin  >> mtx_m >> mtx_n >> mtx_k;
+	std::cout << "How many matrices are in the batch?: ";
+	std::cin  >> batch;
+	
+	// A budget of 0 uses the tuned configuration of the single shape
+	TunerOptions options = default_tuner_options();
+	std::cout << "What is the largest number of kernel launches to spend (0 to skip tuning)?: ";
+	std::cin  >> options.max_launches;
+	
+	if (mtx_m <= 0 || mtx_n <= 0 || mtx_k <= 0 || batch <= 0){
+		std::cout << "	Matrix dimensions and the batch count must be positive!" << std::endl;
+		return;
 	}
 	
-	clock_t clk_start, clk_end;
+	Session session;
+	if (!session.ready()){
+		return;
+	}
 	
-	printf("Running matrix multiplication for matrices A (%i x %i) and B (%i x %i) ...\n",
-		size, size, size, size);
-	clk_start = clock();
-	for (int i = 0; i < size; i++){
-		for (int j = 0; j < size; j++){
-			matxC[i][j] = 0;
-			for (int k = 0; k < size; k++){
-				matxC[i][j] += matxA[i][k] * matxB[k][j];
-			}
+	KernelConfig config;
+	if (options.max_launches > 0){
+		// Tune for the batch; the best tile for one small matrix is rarely the best
+		// when the batch fills the device
+		std::string filename = "batch_dataset.csv";
+		std::ofstream csv;
+		csv.open(filename);
+		write_csv_header(csv);
+		options.batch = batch;
+		TunerResult result = tune(session, mtx_m, mtx_n, mtx_k, options, csv);
+		csv.close();
+		if (result.best_time < 0){
+			std::cerr << "	Error. No configuration ran successfully!" << std::endl;
+			return;
 		}
+		config = result.best;
+		printf("Best batched configuration after %d of %d candidates, measurements in %s:\n",
+			   result.launches, result.candidates, filename.c_str());
 	}
-	clk_end = clock();
+	else {
+		TuningDB db;
+		db.load();
+		config = tuned_config(db, session.device(), mtx_m, mtx_n, mtx_k);
+	}
+	print_inputs(mtx_m, mtx_n, mtx_k, config);
 	
-	double time = (clk_end - clk_start)/double(CLOCKS_PER_SEC);
+	size_t size_A = (size_t) mtx_m * mtx_k, size_B = (size_t) mtx_k * mtx_n, size_C = (size_t) mtx_m * mtx_n;
+	std::vector<float> A(size_A * batch), B(size_B * batch), C(size_C * batch);
+	seedMatrix(&A[0], A.size());
+	seedMatrix(&B[0], B.size());
 	
-	printf("Elapsed Time is (sec): %f\n", time);
-	printf("Running Time is: %.3f milliseconds\n", time*1000);
+	// One untimed pass of each path builds both kernels and checks the batch
+	double time = run_sgemm_strided_batched(session, config, mtx_m, mtx_n, mtx_k, batch,
+											&A[0], mtx_k, size_A, &B[0], mtx_n, size_B,
+											&C[0], mtx_n, size_C, NULL, NULL, 0);
+	if (time < 0 || run_sgemm(session, config, mtx_m, mtx_n, mtx_k, &A[0], mtx_k, &B[0], mtx_n,
+							  &C[0], mtx_n, NULL, NULL, 0) < 0){
+		std::cout << "	The batched multiply failed!" << std::endl;
+		return;
+	}
 	
-	// Display Matrices
-	printf("\n	Matrix A \n==========================\n");
-	for (int i = 0; i < size; i++){
-		for (int j = 0; j < size; j++){
-			printf("%03.2f\t ", matxA[i][j]);
+	VerifyOptions verify = default_verify_options(VERIFY_FREIVALDS);
+	for (int b = 0; b < batch; b++){
+		VerifyResult verified = verify_sgemm(verify, mtx_m, mtx_n, mtx_k, &A[b*size_A], mtx_k,
+											 &B[b*size_B], mtx_n, &C[b*size_C], mtx_n);
+		if (!verified.passed){
+			printf("	Matrix %d of the batch is not equal (error %.2f times the rounding bound)\n",
+				   b, verified.max_error);
+			return;
 		}
-		printf("\n");
 	}
 	
-	printf("\n	Matrix B \n==========================\n");
-	for (int i = 0; i < size; i++){
-		for (int j = 0; j < size; j++){
-			printf("%03.2f\t ", matxB[i][j]);
+	// The whole batch in one launch, then the same work one launch per matrix; both
+	// timed on the wall clock so launch overhead and transfers count
+	typedef std::chrono::steady_clock clock;
+	clock::time_point start = clock::now();
+	time = run_sgemm_strided_batched(session, config, mtx_m, mtx_n, mtx_k, batch,
+									 &A[0], mtx_k, size_A, &B[0], mtx_n, size_B,
+									 &C[0], mtx_n, size_C, NULL, NULL, 0);
+	double batched_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+	
+	start = clock::now();
+	for (int b = 0; b < batch; b++){
+		if (run_sgemm(session, config, mtx_m, mtx_n, mtx_k, &A[b*size_A], mtx_k,
+					  &B[b*size_B], mtx_n, &C[b*size_C], mtx_n, NULL, NULL, 0) < 0){
+			std::cout << "	The multiply of matrix " << b << " failed!" << std::endl;
+			return;
 		}
-		printf("\n");
 	}
+	double looped_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+	
+	double gflops = batch * sgemm_gflops(mtx_m, mtx_n, mtx_k, 1.0);
+	printf("	Batched: %.3f ms for %d matrices, %.2f GFLOP/s (kernel %.3f ms)\n",
+		   batched_ms, batch, gflops / batched_ms, time);
+	printf("	Looped:  %.3f ms for %d matrices, %.2f GFLOP/s\n",
+		   looped_ms, batch, gflops / looped_ms);
+	printf("	The batch is %.1fx faster than a launch per matrix\n", looped_ms / batched_ms);
+	session.pool().print_report();
+}
+
+void train_model(int argc, char** argv){
 	
-	printf("\n	Matrix C \n==========================\n");
-	for (int i = 0; i < size; i++){
-		for (int j = 0; j < size; j++){
-			printf("%03.2f\t ", matxC[i][j]);
+	// Load every sample of the results dataset, or the ones of the last -g without it
+	std::string filename = results_name() + ".bin";
+	std::vector<Sample> data_x;
+	std::vector<double> data_y;
+	std::vector<std::string> columns;
+	if (!load_results(filename, data_x, data_y, columns) || data_x.size() < 2){
+		filename = "kernel_dataset.csv";
+		if (!load_dataset(filename, data_x, data_y, columns) || data_x.size() < 2){
+			std::cerr << "	Error. Could not read samples from " << filename << ", run with -g first!" << std::endl;
+			exit(1);
 		}
-		printf("\n");
 	}
+	printf("Loaded %d samples from %s\n", (int) data_x.size(), filename.c_str());
+	if (columns.size() != config_features(0, 0, 0, make_config(0, 1)).size() + 1){
+		std::cerr << "	Error. " << filename << " has unexpected columns, run with -g again!" << std::endl;
+		exit(1);
+	}
+	
+	// Splitting the Original Data Into Training and Testing (Half Training/Half Testing)
+	std::vector<int> order(data_x.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::mt19937 rng(2018);
+	std::shuffle(order.begin(), order.end(), rng);
 	
-	//Free
-	for (int i = 0; i < size; ++i) {
-		delete [] matxA[i];
-		delete [] matxB[i];
-		delete [] matxC[i];
+	std::vector<Sample> x_train, x_test;
+	std::vector<double> y_train, y_test;
+	for (size_t i = 0; i < order.size(); i++){
+		if (i < order.size()/2){
+			x_test.push_back(data_x[order[i]]);
+			y_test.push_back(data_y[order[i]]);
+		}
+		else {
+			x_train.push_back(data_x[order[i]]);
+			y_train.push_back(data_y[order[i]]);
+		}
 	}
-	delete [] matxA;
-	delete [] matxB;
-	delete [] matxC;
 	
-	return time;
+	// Fit a Random Forest Model and Print Accuracy on the Test Set
+	RandomForest rf(100);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	rf.fit(x_train, y_train);
+	double fit_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	printf("Trained %d trees on %d samples in %.1f ms\n", rf.size(), (int) x_train.size(), fit_ms);
+	printf("Score (R^2 on %d test samples): %.4f\n", (int) x_test.size(), rf.score(x_test, y_test));
 	
-}
-
-void call_python(int argc, char** argv){
+	// Refit on every sample before answering queries
+	rf.fit(data_x, data_y);
+	
+	// Ask for the shape to rank configurations for
+	int mtx_m, mtx_n, mtx_k;
+	std::cout << "What are the M, N and K dimensions to find the best configuration for?: ";
+	std::cin  >> mtx_m >> mtx_n >> mtx_k;
+	
+	// Predict every candidate configuration the default device can launch, without
+	// launching any of them
+	const DeviceInfo* info = find_device(default_device());
+	std::vector<KernelConfig> candidates;
+	enumerate_configs(candidates, info);
+	std::vector<std::pair<double, int> > ranking(candidates.size());
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < candidates.size(); i++){
+		ranking[i].first = rf.predict(config_features(mtx_m, mtx_n, mtx_k, candidates[i], info));
+		ranking[i].second = i;
+	}
+	std::sort(ranking.begin(), ranking.end());
+	double rank_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
 	
-	//Use System Call to Open Python3 Script
-	system("python3 plotspace.py");
+	printf("Ranked %d configurations in %.0f us (%.2f us each)\n", (int) candidates.size(),
+		   rank_us, rank_us / candidates.size());
+	int top = std::min((int) ranking.size(), 5);
+	for (int i = 0; i < top; i++){
+		printf("	#%d predicted (ms): [%.3f]\n", i + 1, ranking[i].first);
+		print_inputs(mtx_m, mtx_n, mtx_k, candidates[ranking[i].second]);
+	}
 	exit(0);
 }
 
@@ -164,66 +410,510 @@ void generate_samples(int argc, char** argv){
 	std::cin  >> sample_size;
 	
 	// Ask for size of matrix
-	int mtx_dim;
-	std::cout << "What is the X and Y dimensions that you want for the Matrices?: ";
-	std::cin  >> mtx_dim;
+	int mtx_m, mtx_n, mtx_k;
+	std::cout << "What are the M, N and K dimensions that you want for the Matrices?: ";
+	std::cin  >> mtx_m >> mtx_n >> mtx_k;
 	
 	// Inputs (Parameter Space)
-	int x_set1 	 =  mtx_dim;	//Matrix Dimension
-	int x_set2[] = 	{0,1};		//Local Memory 
+	int x_set2[] = 	{0,1,2};		//Local Memory (2 = Register Tiles)
 	int x_set3[] = 	{1,2,4,8,16}; // Block Size Depends of # of Compute Units
+	int x_set4[] = 	{16,32,64,128};	// Tile Sizes TSM and TSN
+	int x_set5[] = 	{8,16,32};		// Tile Depth TSK
+	int x_set6[] = 	{1,2,4,8};		// Work Per Thread WPTM and WPTN
+	int x_set7[] = 	{1,2,4,8};		// Vector Width of Global Loads
+	int x_set8[] = 	{0,1};			// Edge Tiles Padded (0) or Guarded (1)
 	
 	// Size of Input Sets
 	int set2_size = sizeof(x_set2)/sizeof(int);
 	int set3_size = sizeof(x_set3)/sizeof(int);
+	int set4_size = sizeof(x_set4)/sizeof(int);
+	int set5_size = sizeof(x_set5)/sizeof(int);
+	int set6_size = sizeof(x_set6)/sizeof(int);
+	int set7_size = sizeof(x_set7)/sizeof(int);
+	int set8_size = sizeof(x_set8)/sizeof(int);
 	
-	// Display Values False - Only Want Execution Samples
-	int display = 0;
+	// Each sample is the median of repeated launches, checked in O(n^2)
+	BenchmarkOptions bench = default_benchmark_options();
+	VerifyOptions verify = default_verify_options(VERIFY_FREIVALDS);
 	
 	// Set the seed of the pseudorandom number generator
 	srand(2018);
 	
+	// One OpenCL session for the whole sweep; each kernel variant is built once
+	Session session;
+	if (!session.ready()){
+		csv.close();
+		return;
+	}
+	
+	// The fastest sample is kept in the tuning database
+	TuningDB db;
+	db.load();
+	std::string device = device_identity(session.device());
+	
+	// Every sample is also appended to the results dataset
+	ResultsWriter results;
+	results.open(results_name(), session.info());
+	
+	// Fastest sample of each kernel variant for the roofline report
+	double variant_time[3] = {-1, -1, -1};
+	
+	// The first vectorized sample of each variant uses the width the device prefers
+	int preferred_width = session.preferred_vector_width();
+	bool tried_preferred[3] = {false, true, false};
+	
 	//Generate the Headers for the CSV Table
-	csv << "Time"  << ",";
-	csv << "Matrix_Dim" << ",";
-	csv << "Local_Mem" << ",";
-	csv << "Block_Size" << "\n";
+	write_csv_header(csv);
 	
-	//Main Loop
+	// Draw every configuration first, so the sampler can keep the next ones in flight
+	std::vector<KernelConfig> configs;
 	for(int i = 0; i < sample_size; i++){
 		
 		//Test for Inputs Sets
-		int x1 = x_set1;
 		int x2 = x_set2[rand()%set2_size];
 		int x3;
+		int x4;
+		if (!tried_preferred[x2]){
+			x4 = preferred_width;
+			tried_preferred[x2] = true;
+		}
+		else {
+			x4 = x_set7[rand()%set7_size];
+		}
+		KernelConfig config;
 		if (x2 == 0){
 			x3 = x_set3[0];
+			config = make_config(x2, x3, x4);
 		}
-		else {
+		else if (x2 == 1){
 			x3 = x_set3[rand()%set3_size];
+			config = make_config(x2, x3);
+		}
+		else {
+			// Redraw the register tiles until the work-group can load them evenly
+			x3 = x_set3[0];
+			bool valid = false;
+			for (int tries = 0; tries < 100 && !valid; tries++){
+				if (tries == 50){
+					x4 = x_set7[rand()%set7_size];
+				}
+				config = make_config(x_set4[rand()%set4_size], x_set4[rand()%set4_size],
+									 x_set5[rand()%set5_size],
+									 x_set6[rand()%set6_size], x_set6[rand()%set6_size], x4);
+				valid = check_config(config, 0) && (!session.info() || config_fits(config, *session.info()));
+			}
+			if (!valid){
+				x2 = 1;
+				config = make_config(x2, x3);
+			}
 		}
 		
-		// Display the input for following iteration	
-		printf("Iteration %d\n", i);
-		printf("	Inputs:  [%d, %d, %d]\n", x1, x2, x3);
-
-		// Execute the Kernel from Host Code and Obtain the Execution Time
-		double kernel_time = host(x1,x2,x3, display);
-		printf("	Outputs (ms): [%.3f]\n", kernel_time);
+		config.edge_guard = x_set8[rand()%set8_size];
+		configs.push_back(config);
+	}
+	
+	//Main Loop: upload, launch, readback and check of neighbouring samples overlap;
+	//samples far slower than the fastest so far are stopped after one launch
+	PipelinedSampler sampler(session, mtx_m, mtx_n, mtx_k, bench, verify);
+	sampler.set_abort_factor(default_tuner_options().abort_factor);
+	sampler.run(configs, [&](const PipelineSample& sample) {
+		
+		// Display the input of the finished iteration
+		printf("Iteration %d\n", sample.index);
+		print_inputs(mtx_m, mtx_n, mtx_k, sample.config);
+		if (sample.stats.reps > 0 && !sample.verified.passed){
+			printf("	The kernel matrix is not equal (error %.2f times the rounding bound)\n", sample.verified.max_error);
+		}
+		if (sample.stats.aborted){
+			printf("	Stopped after %d launches, far slower than the fastest so far\n", sample.stats.reps);
+		}
+		printf("	Outputs (ms): [%.3f]\n", sample.time);
 		
 		// Output the results to CSV file
-		csv << kernel_time << ",";
-		csv << x1 << ",";
-		csv << x2 << ",";
-		csv << x3 << "\n";
+		write_csv_row(csv, sample.time, mtx_m, mtx_n, mtx_k, sample.config, session.info(),
+					  1, NO_TRANS, NO_TRANS, &sample.stats.phases);
+		append_sample(results, "sample", mtx_m, mtx_n, mtx_k, sample);
+		db.record(device, mtx_m, mtx_n, mtx_k, sample.config, sample.time);
 		
-	}
+		double& variant = variant_time[sample.config.local_mem];
+		if (sample.time >= 0 && (variant < 0 || sample.time < variant)){
+			variant = sample.time;
+		}
+	});
+	sampler.print_report();
 	
 	//Close CSV File
 	csv.close();
+	results.close();
+	
+	if (!db.save()){
+		std::cerr << "	Warning. Could not write " << tuning_db_path() << std::endl;
+	}
 	
 	// Display Successful Execution
 	std::cout << "Success! Results are saved in " << filename << "." << std::endl;
+	if (results.rows() > 0){
+		std::cout << results.rows() << " samples are appended to " << results.dataset()
+				  << ".jsonl and " << results.dataset() << ".bin." << std::endl;
+	}
+	
+	// How close each variant gets to the device peak
+	DevicePeak peak;
+	if (calibrate_device(session, peak)){
+		print_roofline_report(peak, mtx_m, mtx_n, mtx_k, variant_time);
+	}
+	
+	std::cout << "Kernel variants compiled: " << session.build_count()
+			  << ", loaded from cache: " << session.cache_hit_count() << std::endl;
+	session.pool().print_report();
+}
+
+
+void sweep_samples(int argc, char** argv){
+	
+	// Settings are name=value arguments after -w, so a sweep needs no prompts:
+	// space=FILE, param="DEFINITION", shapes=MxNxK,..., sampler=exhaustive|random|lhs,
+	// samples=N (per shape), seed=N, out=FILE, abort=F (stop a sample F times slower
+	// than the fastest of its shape, 0 to time every sample in full) and results=NAME
+	// (the dataset every sample is appended to)
+	std::string space_path;
+	std::vector<std::string> definitions;
+	std::vector<std::string> shape_lists;
+	SamplerKind kind = SAMPLE_LATIN;
+	int sample_size = 100;
+	unsigned seed = 2018;
+	std::string filename = "sweep_dataset.csv";
+	double abort_factor = default_tuner_options().abort_factor;
+	std::string dataset = results_name();
+	for (int i = 1; i < argc; i++){
+		std::string arg = argv[i];
+		size_t equals = arg.find('=');
+		if (arg[0] == '-' || equals == std::string::npos){
+			continue;
+		}
+		std::string key = arg.substr(0, equals);
+		std::string value = arg.substr(equals + 1);
+		if (key == "space"){
+			space_path = value;
+		}
+		else if (key == "param"){
+			definitions.push_back(value);
+		}
+		else if (key == "shape" || key == "shapes"){
+			shape_lists.push_back(value);
+		}
+		else if (key == "sampler"){
+			if (!parse_sampler(value, kind)){
+				std::cerr << "	Error. The sampler must be exhaustive, random or lhs!" << std::endl;
+				return;
+			}
+		}
+		else if (key == "samples"){
+			sample_size = atoi(value.c_str());
+		}
+		else if (key == "seed"){
+			seed = strtoul(value.c_str(), NULL, 10);
+		}
+		else if (key == "out"){
+			filename = value;
+		}
+		else if (key == "abort"){
+			abort_factor = atof(value.c_str());
+		}
+		else if (key == "results"){
+			dataset = value;
+		}
+		else {
+			std::cerr << "	Error. Unknown sweep setting " << key << "!" << std::endl;
+			return;
+		}
+	}
+	
+	// The space file, or the space of -a without one; param= definitions go on top
+	SearchSpace space;
+	if (space_path.empty()){
+		default_search_space(space);
+	}
+	else if (!space.load(space_path)){
+		return;
+	}
+	for (size_t d = 0; d < definitions.size(); d++){
+		if (!space.add(definitions[d])){
+			return;
+		}
+	}
+	for (size_t s = 0; s < shape_lists.size(); s++){
+		if (!space.add_shapes(shape_lists[s])){
+			return;
+		}
+	}
+	if (space.shapes().empty()){
+		std::cerr << "	Error. The sweep has no shapes; add shape lines or shapes=MxNxK!" << std::endl;
+		return;
+	}
+	
+	// One OpenCL session for every shape; each kernel variant is built once
+	Session session;
+	if (!session.ready()){
+		return;
+	}
+	
+	// Shapes and configurations the device cannot hold are dropped before any launch
+	std::vector<SearchShape> shapes;
+	space.fitting_shapes(shapes, session.info());
+	
+	std::ofstream csv;
+	csv.open(filename);
+	write_csv_header(csv);
+	
+	// Appended to sample by sample, so an interrupted sweep keeps what it measured
+	ResultsWriter results;
+	if (!results.open(dataset, session.info())){
+		return;
+	}
+	
+	TuningDB db;
+	db.load();
+	std::string device = device_identity(session.device());
+	
+	BenchmarkOptions bench = default_benchmark_options();
+	VerifyOptions verify = default_verify_options(VERIFY_FREIVALDS);
+	
+	int total = 0;
+	for (size_t s = 0; s < shapes.size(); s++){
+		const SearchShape& shape = shapes[s];
+		
+		// A new draw per shape, so random and Latin hypercube sweeps cover more of the space
+		std::vector<KernelConfig> configs;
+		int pruned = 0;
+		space.sample(kind, sample_size, seed + s, configs, session.info(), &pruned);
+		printf("\nShape %d x %d x %d: %d configurations, %d pruned before launch\n",
+			   shape.M, shape.N, shape.K, (int) configs.size(), pruned);
+		
+		double best_time = -1;
+		KernelConfig best;
+		PipelinedSampler sampler(session, shape.M, shape.N, shape.K, bench, verify);
+		sampler.set_abort_factor(abort_factor);
+		sampler.run(configs, [&](const PipelineSample& sample) {
+			if (sample.stats.reps > 0 && !sample.verified.passed){
+				printf("	Sample %d: the kernel matrix is not equal (error %.2f times the rounding bound)\n",
+					   sample.index, sample.verified.max_error);
+			}
+			write_csv_row(csv, sample.time, shape.M, shape.N, shape.K, sample.config, session.info(),
+						  1, NO_TRANS, NO_TRANS, &sample.stats.phases);
+			append_sample(results, "sweep", shape.M, shape.N, shape.K, sample);
+			db.record(device, shape.M, shape.N, shape.K, sample.config, sample.time);
+			if (sample.time >= 0 && (best_time < 0 || sample.time < best_time)){
+				best_time = sample.time;
+				best = sample.config;
+			}
+		});
+		sampler.print_report();
+		total += configs.size();
+		
+		// Each finished shape is on disk even if a later one is interrupted
+		csv.flush();
+		results.flush();
+		if (best_time >= 0){
+			printf("Best of %d x %d x %d [%.3f ms]\n", shape.M, shape.N, shape.K, best_time);
+			print_inputs(shape.M, shape.N, shape.K, best);
+		}
+	}
+	csv.close();
+	results.close();
+	
+	if (!db.save()){
+		std::cerr << "	Warning. Could not write " << tuning_db_path() << std::endl;
+	}
+	
+	std::cout << "Success! " << total << " samples over " << shapes.size()
+			  << " shapes are saved in " << filename << " and appended to "
+			  << dataset << ".jsonl and " << dataset << ".bin." << std::endl;
+	std::cout << "Kernel variants compiled: " << session.build_count()
+			  << ", loaded from cache: " << session.cache_hit_count() << std::endl;
+	session.pool().print_report();
+}
+
+
+void adaptive_tuning(int argc, char** argv){
+	
+	// Set CSV File; kept apart from the -g samples in kernel_dataset.csv, which -r and the
+	// tuning database train on when there is no results dataset
+	std::string filename;
+	filename = "tune_dataset.csv";
+	std::ofstream csv;
+	csv.open(filename);
+	
+	// Ask for size of matrix
+	int mtx_m, mtx_n, mtx_k;
+	std::cout << "What are the M, N and K dimensions that you want for the Matrices?: ";
+	std::cin  >> mtx_m >> mtx_n >> mtx_k;
+	
+	// Ask for the layout; each of NN, NT, TN and TT is tuned on its own
+	TunerOptions options = default_tuner_options();
+	std::string layout;
+	std::cout << "Which layout of op(A) * op(B) (NN, NT, TN or TT)?: ";
+	std::cin  >> layout;
+	if (!parse_layout(layout, options.trans_a, options.trans_b)){
+		std::cout << "	The layout must be NN, NT, TN or TT!" << std::endl;
+		csv.close();
+		return;
+	}
+	
+	// Ask for the launch budget
+	std::cout << "What is the largest number of kernel launches to spend?: ";
+	std::cin  >> options.max_launches;
+	
+	// Ask for the search strategy; "all" runs each of them on the same budget
+	std::string strategy;
+	std::vector<SearchStrategy> strategies;
+	std::cout << "Which search strategy (model, genetic, annealing or all)?: ";
+	std::cin  >> strategy;
+	if (strategy == "all"){
+		strategies.push_back(SEARCH_MODEL);
+		strategies.push_back(SEARCH_GENETIC);
+		strategies.push_back(SEARCH_ANNEALING);
+	}
+	else if (parse_strategy(strategy, options.strategy)){
+		strategies.push_back(options.strategy);
+	}
+	else {
+		std::cout << "	The strategy must be model, genetic, annealing or all!" << std::endl;
+		csv.close();
+		return;
+	}
+
+	// Rank by the kernel alone, or by what a host caller pays including the transfers
+	std::string objective;
+	std::cout << "Rank by kernel or total time?: ";
+	std::cin  >> objective;
+	if (!parse_objective(objective, options.objective)){
+		std::cout << "	The objective must be kernel or total!" << std::endl;
+		csv.close();
+		return;
+	}
+	
+	// One OpenCL session for the whole search; each kernel variant is built once
+	Session session;
+	if (!session.ready()){
+		csv.close();
+		return;
+	}
+	
+	//Generate the Headers for the CSV Table
+	write_csv_header(csv);
+	
+	// Every launch is also appended to the results dataset
+	ResultsWriter results;
+	if (results.open(results_name(), session.info())){
+		options.results = &results;
+	}
+	
+	// Best time after each launch of each strategy, to compare how fast they converge
+	std::string convergence_file = "convergence.csv";
+	std::ofstream convergence;
+	convergence.open(convergence_file);
+	convergence << "Strategy,Launch,Best_Time" << std::endl;
+	
+	// The strategies share one cache, so none of them launches a configuration twice
+	MeasureCache cache;
+	TunerResult result;
+	std::vector<TunerResult> runs;
+	for (size_t s = 0; s < strategies.size(); s++){
+		options.strategy = strategies[s];
+		printf("\n%s search\n==========================\n", strategy_name(options.strategy));
+		runs.push_back(tune(session, mtx_m, mtx_n, mtx_k, options, csv, &cache));
+		
+		const TunerResult& run = runs.back();
+		for (size_t l = 0; l < run.history.size(); l++){
+			convergence << strategy_name(options.strategy) << "," << l + 1 << "," << run.history[l] << std::endl;
+		}
+		printf("%d launches, %d stopped early, %d ruled out by the model, %d answered from the cache\n",
+			   run.launches, run.aborted, run.skipped, run.cached);
+		if (s == 0 || (run.best_time >= 0 && (result.best_time < 0 || run.best_time < result.best_time))){
+			result = run;
+		}
+	}
+	
+	//Close CSV File
+	csv.close();
+	convergence.close();
+	results.close();
+	options.results = NULL;
+	
+	// Best time of each strategy after 1, 2, 5, 10, 20, 50, ... launches
+	if (runs.size() > 1){
+		printf("\nBest time (ms) against launches used\n");
+		printf("	%-10s", "Launches");
+		for (size_t s = 0; s < runs.size(); s++){
+			printf("%12s", strategy_name(strategies[s]));
+		}
+		printf("\n");
+		for (int decade = 1; decade <= options.max_launches; decade *= 10){
+			static const int steps[] = {1, 2, 5};
+			for (int i = 0; i < 3 && steps[i] * decade <= options.max_launches; i++){
+				int launch = steps[i] * decade;
+				printf("	%-10d", launch);
+				for (size_t s = 0; s < runs.size(); s++){
+					const std::vector<double>& history = runs[s].history;
+					if (history.empty())
+						printf("%12s", "-");
+					else
+						printf("%12.3f", history[std::min((size_t) launch, history.size()) - 1]);
+				}
+				printf("\n");
+			}
+		}
+		int hits = 0;
+		for (size_t s = 0; s < runs.size(); s++){
+			hits += runs[s].cached;
+		}
+		printf("	(%d configurations measured, %d answered from the cache)\n", cache.size(), hits);
+	}
+	
+	if (result.best_time < 0){
+		std::cerr << "	Error. No configuration ran successfully!" << std::endl;
+		return;
+	}
+	
+	// Display the Best Configuration Found
+	if (result.candidates > 0){
+		printf("Best %s configuration after %d of %d candidates (%.1f%%):\n",
+			   layout_name(options.trans_a, options.trans_b), result.launches,
+			   result.candidates, 100.0 * result.launches / result.candidates);
+	}
+	else {
+		printf("Best %s configuration after %d launches:\n",
+			   layout_name(options.trans_a, options.trans_b), result.launches);
+	}
+	print_inputs(mtx_m, mtx_n, mtx_k, result.best);
+	if (options.objective == OBJECTIVE_END_TO_END){
+		printf("	Outputs (ms): [%.3f] end to end, [%.3f] kernel\n", result.best_time,
+			   result.best_kernel_time);
+	}
+	else {
+		printf("	Outputs (ms): [%.3f]\n", result.best_time);
+	}
+	session.pool().print_report();
+	
+	// Keep the result for later runs of this shape; like every other mode it records the
+	// kernel time, whatever the objective chose the configuration by
+	TuningDB db;
+	db.load();
+	db.record(device_identity(session.device()), mtx_m, mtx_n, mtx_k, result.best, result.best_kernel_time,
+			  options.trans_a, options.trans_b);
+	if (!db.save()){
+		std::cerr << "	Warning. Could not write " << tuning_db_path() << std::endl;
+	}
+	
+	// How close the kernel of each variant gets to the device peak
+	DevicePeak peak;
+	if (calibrate_device(session, peak)){
+		print_roofline_report(peak, mtx_m, mtx_n, mtx_k, result.variant_kernel_time);
+	}
+	
+	std::cout << "Success! Results are saved in " << filename << ", " << convergence_file
+			  << " and " << tuning_db_path() << "." << std::endl;
 }
 
 
@@ -235,11 +925,21 @@ void parse_args(int argc, char** argv){
 			case 'h':
 				print_help(argc, argv);
 				break;
+			case 'a':
+				// Model-Guided Search for the Best Configuration
+				adaptive_tuning(argc, argv);
+				exit(1);
+				break;
 			case 'g':
 				// Samples Function to Random Forest Usage
 				generate_samples(argc, argv);
 				exit(1);
 				break;
+			case 'w':
+				// Unattended sweep of a declarative search space
+				sweep_samples(argc, argv);
+				exit(1);
+				break;
 			case 'l':
 				//Function taken from devInfo.hpp
 				devicequery();
@@ -250,9 +950,19 @@ void parse_args(int argc, char** argv){
 				basic_matrix();
 				exit(1);
 				break;
+			case 's':
+				//Heterogeneous split over every device
+				split_sgemm(argc, argv);
+				exit(1);
+				break;
+			case 'b':
+				//Many small multiplies in one launch
+				batched_sgemm(argc, argv);
+				exit(1);
+				break;
 			case 'r':
-				//Execute Random Forest Python Script
-				call_python(argc, argv);
+				//Train the Random Forest Performance Model
+				train_model(argc, argv);
 				exit(1);
 				break;
 			default:
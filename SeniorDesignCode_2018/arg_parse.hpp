@@ -46,8 +46,12 @@
 
 void print_help(int argc, char** argv);
 double basic_matrix();
-void call_python(int argc, char** argv);
+void train_model(int argc, char** argv);
 void generate_samples(int argc, char** argv);
+void sweep_samples(int argc, char** argv);
+void adaptive_tuning(int argc, char** argv);
+void split_sgemm(int argc, char** argv);
+void batched_sgemm(int argc, char** argv);
 void parse_args(int argc, char** argv);
         
 #endif
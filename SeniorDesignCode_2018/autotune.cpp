@@ -0,0 +1,146 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: autotune.cpp
+//	Function(s): Autotuner::Autotuner(), Autotuner::sgemm(), Autotuner::tune(),
+//				 Autotuner::sgemm_strided_batched(), Autotuner::config(),
+//				 default_autotune_options()
+//
+//	Purpose: 	The entry point of libautotune. The tuner, the execution engine and
+//				the device inventory are built into the library; oclsgemm is one
+//				client of it, and a service links the same library to run tuned
+//				SGEMM with the session opened once per process.
+//
+/****************************************************************************************/
+
+#include "autotune.hpp"
+#include "kernel_cache.hpp"
+
+AutotuneOptions default_autotune_options()
+{
+	AutotuneOptions options;
+	options.device 			= -1;
+	options.kernel_path 	= default_kernel_path();
+	options.cache_dir 		= cache_directory();
+	options.db_path 		= tuning_db_path();
+	options.model_path 		= "kernel_dataset.csv";
+	options.dataset_path 	= "";
+	options.results_name 	= "";
+	return options;
+}
+
+Autotuner::Autotuner(const AutotuneOptions& options)
+	: settings(options), ocl(NULL), db(options.db_path, options.model_path)
+{
+	cl_device_id device = NULL;
+	if (options.device < 0){
+		device = default_device();
+	}
+	else {
+		std::vector<cl_device_id> devices = opencl_devices();
+		if (options.device < (int) devices.size())
+			device = devices[options.device];
+		else
+			std::cerr << "	Error. There is no OpenCL device " << options.device << "!" << std::endl;
+	}
+	ocl = new Session(device, options.kernel_path.c_str(), options.cache_dir.c_str());
+	db.load();
+}
+
+Autotuner::~Autotuner()
+{
+	delete ocl;
+}
+
+bool Autotuner::ready() const
+{
+	return ocl->ready();
+}
+
+const DeviceInfo* Autotuner::device() const
+{
+	return ocl->info();
+}
+
+double Autotuner::sgemm(const Transpose trans_a, const Transpose trans_b,
+						const int M, const int N, const int K, const float alpha,
+						const float* A, const int lda,
+						const float* B, const int ldb, const float beta,
+						float* C,       const int ldc)
+{
+	if (!ready())
+		return -1;
+	return ::sgemm(*ocl, db, trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+double Autotuner::sgemm_strided_batched(const int M, const int N, const int K, const int batch,
+										const float* A, const int lda, const long long stride_A,
+										const float* B, const int ldb, const long long stride_B,
+										float* C,       const int ldc, const long long stride_C)
+{
+	if (!ready())
+		return -1;
+	return run_sgemm_strided_batched(*ocl, config(M, N, K), M, N, K, batch,
+									 A, lda, stride_A, B, ldb, stride_B, C, ldc, stride_C,
+									 NULL, NULL, 0);
+}
+
+KernelConfig Autotuner::config(const int M, const int N, const int K,
+							   const Transpose trans_a, const Transpose trans_b)
+{
+	return tuned_config(db, ocl->device(), M, N, K, trans_a, trans_b);
+}
+
+TunerResult Autotuner::tune(const int M, const int N, const int K, const TunerOptions& options)
+{
+	TunerResult result;
+	result.best_time = -1;
+	result.best_kernel_time = -1;
+	result.launches = 0;
+	result.candidates = 0;
+	for (int v = 0; v < 3; v++)
+		result.variant_time[v] = result.variant_kernel_time[v] = -1;
+	if (!ready())
+		return result;
+
+	// Measurements are appended; a new file gets the header first
+	std::ofstream csv;
+	if (!settings.dataset_path.empty()){
+		std::ifstream existing(settings.dataset_path.c_str());
+		bool fresh = !existing || existing.peek() == std::ifstream::traits_type::eof();
+		existing.close();
+		csv.open(settings.dataset_path.c_str(), std::ios::app);
+		if (csv.is_open() && fresh)
+			write_csv_header(csv);
+	}
+
+	// The results dataset is opened per call, so nothing stays unsynced between calls
+	ResultsWriter results;
+	TunerOptions run = options;
+	if (!settings.results_name.empty() && results.open(settings.results_name, ocl->info()))
+		run.results = &results;
+
+	result = ::tune(*ocl, M, N, K, run, csv);
+	results.close();
+
+	// A batched optimum is not the answer for a single multiply of the shape. The
+	// database compares kernel times, whatever the objective chose the configuration by
+	if (result.best_time >= 0 && options.batch <= 1){
+		db.record(device_identity(ocl->device()), M, N, K, result.best, result.best_kernel_time,
+				  options.trans_a, options.trans_b);
+		if (!db.save())
+			std::cerr << "	Warning. Could not write " << settings.db_path << std::endl;
+	}
+	return result;
+}
@@ -0,0 +1,99 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: autotune.hpp
+//	Purpose of File: Header File for autotune.cpp, the public interface of libautotune
+//
+/****************************************************************************************/
+
+#ifndef AUTOTUNE
+#define AUTOTUNE
+
+#include <string>
+#include <vector>
+
+#include "devInfo.hpp"
+#include "host.hpp"
+#include "batched.hpp"
+#include "tuner.hpp"
+#include "tuning_db.hpp"
+#include "results.hpp"
+
+// Where an Autotuner runs and keeps its files
+struct AutotuneOptions {
+	int 		device;			// index into opencl_devices(), -1 for default_device()
+	std::string kernel_path;	// OpenCL source of the kernels
+	std::string cache_dir;		// compiled kernel binaries, "" to keep them in memory only
+	std::string db_path;		// tuning database read on start and written by tune()
+	std::string model_path;		// CSV samples config() trains its model on, "" for none
+	std::string dataset_path;	// CSV that tune() appends every measurement to, "" for none
+	std::string results_name;	// results dataset (results.hpp) of tune(), "" for none
+};
+
+// OCLSGEMM_DEVICE, OCLSGEMM_KERNEL, OCLSGEMM_CACHE_DIR and OCLSGEMM_TUNING_DB, or their
+// defaults, the -g samples in kernel_dataset.csv for the model, and no dataset or results
+AutotuneOptions default_autotune_options();
+
+// Tuned SGEMM for one device. Creating it opens the OpenCL session and loads the
+// tuning database, so a process pays for that once and every later call only runs
+// kernels (built on first use of a configuration, or loaded from the binary cache).
+// Nothing is read from stdin and no file is written except those named in the options.
+class Autotuner {
+public:
+	explicit Autotuner(const AutotuneOptions& options = default_autotune_options());
+	~Autotuner();
+
+	bool ready() const;
+
+	// Capabilities of the device, NULL when it could not be queried
+	const DeviceInfo* device() const;
+
+	// C = alpha * op(A) * op(B) + beta * C with the tuned configuration of the shape
+	// and layout (see sgemm() in tuning_db.hpp). Returns the kernel time in ms, -1 on
+	// failure.
+	double sgemm(const Transpose trans_a, const Transpose trans_b,
+				 const int M, const int N, const int K, const float alpha,
+				 const float* A, const int lda,
+				 const float* B, const int ldb, const float beta,
+				 float* C,       const int ldc);
+
+	// C[b] = A[b] * B[b] for a batch of same-shape matrices in one launch
+	double sgemm_strided_batched(const int M, const int N, const int K, const int batch,
+								 const float* A, const int lda, const long long stride_A,
+								 const float* B, const int ldb, const long long stride_B,
+								 float* C,       const int ldc, const long long stride_C);
+
+	// Configuration sgemm() would use for this shape and layout
+	KernelConfig config(const int M, const int N, const int K,
+						const Transpose trans_a = NO_TRANS, const Transpose trans_b = NO_TRANS);
+
+	// Model-guided search for the shape and layout of options. The best single-matrix
+	// configuration is recorded and the database saved.
+	TunerResult tune(const int M, const int N, const int K,
+					 const TunerOptions& options = default_tuner_options());
+
+	// The pieces underneath, for callers that need more than the calls above
+	Session& session() 		{ return *ocl; }
+	TuningDB& database() 	{ return db; }
+
+private:
+	Autotuner(const Autotuner&);
+	Autotuner& operator=(const Autotuner&);
+
+	AutotuneOptions settings;
+	Session* 		ocl;
+	TuningDB 		db;
+};
+
+#endif
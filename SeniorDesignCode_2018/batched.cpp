@@ -0,0 +1,343 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: batched.cpp
+//	Function(s): run_sgemm_batched(), run_sgemm_strided_batched(), host_batched()
+//
+//	Purpose: 	Many small multiplies in one launch. A 32 x 32 multiply finishes in
+//				a few microseconds, less than it takes to set up and launch it, so
+//				a workload of thousands of them is all overhead when each one is its
+//				own run_sgemm(). Here every matrix of the batch is packed (and padded
+//				to whole tiles) into one buffer per operand, and the kernel built
+//				with BATCHED=1 takes the matrix from the third NDRange dimension.
+//
+/****************************************************************************************/
+
+#include "batched.hpp"
+#include "roofline.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+// Copy rows x cols (leading dimension ld) into a dense run_rows x run_cols block
+static void pack_matrix(const float* src, int rows, int cols, int ld,
+						float* dst, int run_rows, int run_cols)
+{
+	if (run_rows == rows && run_cols == cols && ld == cols)
+		memcpy(dst, src, sizeof(float) * rows * cols);
+	else
+		copy_padded(src, rows, cols, ld, dst, run_rows, run_cols);
+}
+
+// Copy the rows x cols corner of a dense block with run_cols columns out to dst
+static void unpack_matrix(const float* src, int rows, int cols, int run_cols,
+						  float* dst, int ld)
+{
+	for (int i = 0; i < rows; i++)
+		memcpy(dst + (size_t) i*ld, src + (size_t) i*run_cols, sizeof(float) * cols);
+}
+
+// Fill a device buffer with one dense block per matrix, through a mapping when the
+// device shares host memory and from pinned staging otherwise
+static bool upload_batch(cl_command_queue queue, BufferPool& pool, cl_mem buffer,
+						 const float* const* src, int batch, int rows, int cols, int ld,
+						 int run_rows, int run_cols, std::vector<cl_event>& events)
+{
+	cl_int err;
+	cl_event event = NULL;
+	size_t block = (size_t) run_rows * run_cols;
+	size_t bytes = sizeof(float) * block * batch;
+
+	if (pool.zero_copy()){
+		float* dst = (float*) clEnqueueMapBuffer(queue, buffer, CL_TRUE, CL_MAP_WRITE, 0, bytes, 0, NULL, &event, &err);
+		if (err != CL_SUCCESS || !dst){
+			std::cerr << "	Error. Failed to map device memory!" << err << std::endl;
+			return false;
+		}
+		events.push_back(event);
+		for (int b = 0; b < batch; b++)
+			pack_matrix(src[b], rows, cols, ld, dst + b*block, run_rows, run_cols);
+		if (clEnqueueUnmapMemObject(queue, buffer, dst, 0, NULL, &event) != CL_SUCCESS)
+			return false;
+		events.push_back(event);
+		return true;
+	}
+
+	PinnedHost staging(pool, bytes);
+	if (!staging.get())
+		return false;
+	for (int b = 0; b < batch; b++)
+		pack_matrix(src[b], rows, cols, ld, staging.get() + b*block, run_rows, run_cols);
+	if ((err = clEnqueueWriteBuffer(queue, buffer, CL_TRUE, 0, bytes, staging.get(), 0, NULL, &event)) != CL_SUCCESS){
+		std::cerr << "	Error. Failed to write the input arrays!" << err << std::endl;
+		return false;
+	}
+	events.push_back(event);
+	return true;
+}
+
+static bool download_batch(cl_command_queue queue, BufferPool& pool, cl_mem buffer,
+						   float* const* dst, int batch, int rows, int cols, int ld,
+						   int run_rows, int run_cols, std::vector<cl_event>& events)
+{
+	cl_int err;
+	cl_event event = NULL;
+	size_t block = (size_t) run_rows * run_cols;
+	size_t bytes = sizeof(float) * block * batch;
+
+	if (pool.zero_copy()){
+		float* src = (float*) clEnqueueMapBuffer(queue, buffer, CL_TRUE, CL_MAP_READ, 0, bytes, 0, NULL, &event, &err);
+		if (err != CL_SUCCESS || !src)
+			return false;
+		events.push_back(event);
+		for (int b = 0; b < batch; b++)
+			unpack_matrix(src + b*block, rows, cols, run_cols, dst[b], ld);
+		if (clEnqueueUnmapMemObject(queue, buffer, src, 0, NULL, &event) != CL_SUCCESS)
+			return false;
+		events.push_back(event);
+		return true;
+	}
+
+	PinnedHost staging(pool, bytes);
+	if (!staging.get() ||
+		clEnqueueReadBuffer(queue, buffer, CL_TRUE, 0, bytes, staging.get(), 0, NULL, &event) != CL_SUCCESS)
+		return false;
+	events.push_back(event);
+	for (int b = 0; b < batch; b++)
+		unpack_matrix(staging.get() + b*block, rows, cols, run_cols, dst[b], ld);
+	return true;
+}
+
+double run_sgemm_batched(Session& session,   const KernelConfig& config,
+						 const int M, const int N, const int K, const int batch,
+						 const float* const* A, const int lda,
+						 const float* const* B, const int ldb,
+						 float* const* C,       const int ldc,
+						 const BenchmarkOptions* bench, BenchmarkStats* stats,
+						 const int display){
+
+	if(!check_config(config)){
+		return -1;
+	}
+
+	if(!session.ready()){
+		std::cerr << "	Error. OpenCL session is not available!" << std::endl;
+		return -1;
+	}
+
+	if(session.info() && !config_fits(config, *session.info(), 1)){
+		return -1;
+	}
+
+	if (M <= 0 || N <= 0 || K <= 0 || batch <= 0){
+		std::cout << "	Matrix dimensions and the batch count must be positive!" << std::endl;
+		return -1;
+	}
+
+	PhaseTimes phases = no_phases();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	cl_kernel kernel = session.get_kernel(build_options(config, 1), "sgemm");
+	if (!kernel){
+		return -1;
+	}
+	phases.build = elapsed_ms(start);
+	start = std::chrono::steady_clock::now();
+
+	// Each matrix becomes a dense block of whole tiles (or of its own size when guarded)
+	int run_M, run_N, run_K;
+	padded_size(config, M, N, K, run_M, run_N, run_K);
+
+	long long block_A = (long long) run_M * run_K;
+	long long block_B = (long long) run_K * run_N;
+	long long block_C = (long long) run_M * run_N;
+	long long largest = std::max(block_A, std::max(block_B, block_C));
+
+	// The kernel indexes each operand with int
+	if (largest * batch >= INT_MAX){
+		std::cerr << "	Error. The batch is too large for one launch!" << std::endl;
+		return -1;
+	}
+	size_t bytes_A = sizeof(float) * block_A * batch;
+	size_t bytes_B = sizeof(float) * block_B * batch;
+	size_t bytes_C = sizeof(float) * block_C * batch;
+	if (session.info() && session.info()->max_alloc > 0 &&
+		sizeof(float) * largest * batch > session.info()->max_alloc){
+		std::cerr << "	Error. The batch is larger than the biggest buffer the device allows!" << std::endl;
+		return -1;
+	}
+
+	cl_command_queue queue = session.queue();
+	BufferPool& pool = session.pool();
+	cl_mem_flags flags = CL_MEM_READ_WRITE | (pool.zero_copy() ? CL_MEM_ALLOC_HOST_PTR : 0);
+	PooledBuffer d_A(pool, bytes_A, flags);
+	PooledBuffer d_B(pool, bytes_B, flags);
+	PooledBuffer d_C(pool, bytes_C, flags);
+	if (!d_A.get() || !d_B.get() || !d_C.get()){
+		return -1;
+	}
+
+	std::vector<cl_event> transfers;
+	if (!upload_batch(queue, pool, d_A.get(), A, batch, M, K, lda, run_M, run_K, transfers) ||
+		!upload_batch(queue, pool, d_B.get(), B, batch, K, N, ldb, run_K, run_N, transfers)){
+		drain_events(transfers);
+		return -1;
+	}
+	phases.upload = drain_events(transfers);
+
+	cl_int err = set_sgemm_args(kernel, d_C.get(), d_A.get(), d_B.get(),
+								run_M, run_N, run_K, run_K, run_N, run_N);
+	int stride_A = block_A, stride_B = block_B, stride_C = block_C;
+	err |= clSetKernelArg(kernel, 11, sizeof(int), (void *)&stride_A);
+	err |= clSetKernelArg(kernel, 12, sizeof(int), (void *)&stride_B);
+	err |= clSetKernelArg(kernel, 13, sizeof(int), (void *)&stride_C);
+	if (err != CL_SUCCESS){
+		std::cerr << "	Error. Failed to set kernel arguments!" << err << std::endl;
+		return -1;
+	}
+
+	// The tiles of one matrix in dimensions 0 and 1, the matrix in dimension 2
+	size_t localWorkSize[3], globalWorkSize[3];
+	launch_size(config, run_M, run_N, localWorkSize, globalWorkSize);
+	localWorkSize[2] = 1;
+	globalWorkSize[2] = batch;
+
+	// Host work before the launches is what the wall clock saw beyond the uploads
+	phases.host = std::max(0.0, elapsed_ms(start) - phases.upload);
+
+	BenchmarkOptions options = bench ? *bench : single_run_options();
+	BenchmarkStats result;
+	if ((err = benchmark_kernel(queue, kernel, 3, globalWorkSize, localWorkSize, options, result)) != CL_SUCCESS){
+		return -1;
+	}
+
+	start = std::chrono::steady_clock::now();
+	bool downloaded = download_batch(queue, pool, d_C.get(), C, batch, M, N, ldc, run_M, run_N, transfers);
+	phases.download = drain_events(transfers);
+	phases.host += std::max(0.0, elapsed_ms(start) - phases.download);
+	if (!downloaded){
+		std::cerr << "	Error. Failed to read output array!" << std::endl;
+		return -1;
+	}
+	phases.kernel = result.median;
+	result.phases = phases;
+
+	double time = result.median;
+	if (display){
+		std::cout << "	Execution Time (msec): " << time << " for " << batch << " matrices" << std::endl;
+		printf("	Throughput: %.2f GFLOP/s, %.2f GB/s effective\n",
+			   batch * sgemm_gflops(M, N, K, time), batch * sgemm_bandwidth(M, N, K, time));
+	}
+	if (display && result.reps > 1){
+		print_stats(result);
+	}
+	if (display){
+		print_phases(result.phases);
+	}
+	if (stats){
+		*stats = result;
+	}
+	return time;
+}
+
+double run_sgemm_strided_batched(Session& session,   const KernelConfig& config,
+								 const int M, const int N, const int K, const int batch,
+								 const float* A, const int lda, const long long stride_A,
+								 const float* B, const int ldb, const long long stride_B,
+								 float* C,       const int ldc, const long long stride_C,
+								 const BenchmarkOptions* bench, BenchmarkStats* stats,
+								 const int display){
+
+	std::vector<const float*> As(std::max(batch, 0)), Bs(std::max(batch, 0));
+	std::vector<float*> Cs(std::max(batch, 0));
+	for (int b = 0; b < batch; b++){
+		As[b] = A + b*stride_A;
+		Bs[b] = B + b*stride_B;
+		Cs[b] = C + b*stride_C;
+	}
+	return run_sgemm_batched(session, config, M, N, K, batch, As.data(), lda, Bs.data(), ldb,
+							 Cs.data(), ldc, bench, stats, display);
+}
+
+double host_batched(Session& session,       const int M, const int N, const int K,
+					const int batch, const KernelConfig& config, const int display,
+					const BenchmarkOptions* bench, BenchmarkStats* stats,
+					const VerifyOptions* verify){
+
+	std::cout << " Size of M x N x K: " << M << "x" << N << "x" << K << ", " << batch << " matrices" << std::endl;
+
+	if (M <= 0 || N <= 0 || K <= 0 || batch <= 0){
+		std::cout << "	Matrix dimensions and the batch count must be positive!" << std::endl;
+		return -1;
+	}
+	if (!session.ready()){
+		std::cerr << "	Error. OpenCL session is not available!" << std::endl;
+		return -1;
+	}
+
+	// Every problem of the batch back to back, pinned and kept by the session pool
+	long long size_A = (long long) M * K, size_B = (long long) K * N, size_C = (long long) M * N;
+	PinnedHost pinned_A(session.pool(), sizeof(float) * size_A * batch);
+	PinnedHost pinned_B(session.pool(), sizeof(float) * size_B * batch);
+	PinnedHost pinned_C(session.pool(), sizeof(float) * size_C * batch);
+	float* h_A = pinned_A.get();
+	float* h_B = pinned_B.get();
+	float* h_C = pinned_C.get();
+	if (!h_A || !h_B || !h_C){
+		return -1;
+	}
+	seedMatrix(h_A, size_A * batch);
+	seedMatrix(h_B, size_B * batch);
+
+	BenchmarkStats timing = summarize(std::vector<double>(), 0);
+	double time = run_sgemm_strided_batched(session, config, M, N, K, batch,
+											h_A, K, size_A, h_B, N, size_B, h_C, N, size_C,
+											bench, &timing, display);
+	if (stats){
+		*stats = timing;
+	}
+	if (time < 0){
+		return -1;
+	}
+
+	// A run stopped by the cutoff of bench is already known to be too slow; it is not checked
+	if (timing.aborted){
+		printf("	Stopped after %d launches, slower than %.3f ms\n", timing.reps, bench->abort_ms);
+		return time;
+	}
+
+	// Check every result against the CPU reference
+	VerifyOptions check = verify ? *verify : default_verify_options(VERIFY_FULL);
+	double worst = 0.0, verify_ms = 0.0;
+	for (int b = 0; b < batch; b++){
+		VerifyResult verified = verify_sgemm(check, M, N, K, h_A + b*size_A, K, h_B + b*size_B, N,
+											 h_C + b*size_C, N);
+		verify_ms += verified.ms;
+		worst = std::max(worst, verified.max_error);
+		if (!verified.passed){
+			printf("	Matrix %d of the batch is not equal (error %.2f times the rounding bound)\n",
+				   b, verified.max_error);
+			return -1;
+		}
+	}
+
+	if (check.mode != VERIFY_NONE){
+		printf("	The matrices are equal! (%s check of %d results, error %.2f of the rounding bound)\n",
+			   verify_mode_name(check.mode), batch, worst);
+	}
+	printf("	Kernel Execution Time is %f milliseconds\n", time);
+	printf("	Verification time is %f milliseconds\n", verify_ms);
+
+	return time;
+}
@@ -0,0 +1,52 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: batched.hpp
+//	Purpose of File: Header File for batched.cpp
+//
+/****************************************************************************************/
+
+#ifndef BATCHED_SGEMM
+#define BATCHED_SGEMM
+
+#include "host.hpp"
+
+// C[b] = A[b] * B[b] for every b in [0, batch), one launch for the whole batch. All
+// matrices are row-major with the same M, N, K and leading dimensions. Returns the
+// kernel time in milliseconds for the batch (the median with bench), -1 on failure.
+double run_sgemm_batched(Session& session,   const KernelConfig& config,
+						 const int M, const int N, const int K, const int batch,
+						 const float* const* A, const int lda,
+						 const float* const* B, const int ldb,
+						 float* const* C,       const int ldc,
+						 const BenchmarkOptions* bench = NULL, BenchmarkStats* stats = NULL,
+						 const int display = 1);
+
+// The same with matrix b of each operand starting b strides (in floats) after the first
+double run_sgemm_strided_batched(Session& session,   const KernelConfig& config,
+								 const int M, const int N, const int K, const int batch,
+								 const float* A, const int lda, const long long stride_A,
+								 const float* B, const int ldb, const long long stride_B,
+								 float* C,       const int ldc, const long long stride_C,
+								 const BenchmarkOptions* bench = NULL, BenchmarkStats* stats = NULL,
+								 const int display = 1);
+
+// host() for a batch: seeds batch random problems, runs them in one launch and checks
+// every result
+double host_batched(Session& session,       const int M, const int N, const int K,
+					const int batch, const KernelConfig& config, const int display,
+					const BenchmarkOptions* bench = NULL, BenchmarkStats* stats = NULL,
+					const VerifyOptions* verify = NULL);
+
+#endif
@@ -0,0 +1,321 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: benchmark.cpp
+//	Function(s): benchmark_kernel(), benchmark_more(), enqueue_launches(), event_times(),
+//				 summarize(), benchmark_done(), print_stats(),
+//				 default_benchmark_options(), single_run_options(), no_phases(),
+//				 end_to_end(), print_phases(), drain_events(), elapsed_ms()
+//
+//	Purpose: 	Statistics for repeated kernel timings. run_sgemm() launches a kernel
+//				a few times untimed, then times it until the bootstrap confidence
+//				interval of the median is narrow enough. The median is the time the
+//				samples, the tuner and the tuning database use, since one launch can
+//				be several times off. With a cutoff the launches stop as soon as even
+//				the fastest one is slower than it, which is how the tuner drops
+//				configurations far behind its best.
+//
+//				Besides the kernel, each call is broken into phases (build, host work,
+//				upload, download) so that transfer-bound shapes show up as such.
+//
+/****************************************************************************************/
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+BenchmarkOptions default_benchmark_options()
+{
+	BenchmarkOptions options;
+	options.warmup 				= 2;
+	options.min_reps 			= 5;
+	options.max_reps 			= 50;
+	options.target_rel_error 	= 0.02;
+	options.bootstrap 			= 200;
+	options.abort_ms 			= 0.0;
+	return options;
+}
+
+BenchmarkOptions single_run_options()
+{
+	BenchmarkOptions options;
+	options.warmup 				= 0;
+	options.min_reps 			= 1;
+	options.max_reps 			= 1;
+	options.target_rel_error 	= 0.0;
+	options.bootstrap 			= 0;
+	options.abort_ms 			= 0.0;
+	return options;
+}
+
+PhaseTimes no_phases()
+{
+	PhaseTimes phases;
+	phases.build = phases.host = phases.upload = phases.kernel = phases.download = 0.0;
+	return phases;
+}
+
+double end_to_end(const PhaseTimes& phases)
+{
+	return phases.host + phases.upload + phases.kernel + phases.download;
+}
+
+void print_phases(const PhaseTimes& phases)
+{
+	printf("	Phases (ms): build %.3f, host %.3f, upload %.3f, kernel %.3f, download %.3f, end to end %.3f\n",
+		   phases.build, phases.host, phases.upload, phases.kernel, phases.download, end_to_end(phases));
+}
+
+// Value at fraction q of sorted data, interpolating between neighbours
+static double quantile(const std::vector<double>& sorted, double q)
+{
+	double pos = q * (sorted.size() - 1);
+	size_t lo = (size_t) pos;
+	size_t hi = std::min(lo + 1, sorted.size() - 1);
+	return sorted[lo] + (pos - lo) * (sorted[hi] - sorted[lo]);
+}
+
+BenchmarkStats summarize(const std::vector<double>& samples, const int bootstrap)
+{
+	BenchmarkStats stats;
+	stats.reps = samples.size();
+	stats.aborted = false;
+	stats.phases = no_phases();
+	if (samples.empty()){
+		stats.min = stats.median = stats.mean = stats.stddev = stats.p95 = -1;
+		stats.ci_low = stats.ci_high = -1;
+		stats.rel_error = 0;
+		return stats;
+	}
+
+	std::vector<double> sorted(samples);
+	std::sort(sorted.begin(), sorted.end());
+
+	double sum = 0.0;
+	for (size_t i = 0; i < sorted.size(); i++)
+		sum += sorted[i];
+	stats.mean = sum / sorted.size();
+
+	double var = 0.0;
+	for (size_t i = 0; i < sorted.size(); i++)
+		var += (sorted[i] - stats.mean) * (sorted[i] - stats.mean);
+	stats.stddev = sorted.size() > 1 ? sqrt(var / (sorted.size() - 1)) : 0.0;
+
+	stats.min = sorted[0];
+	stats.median = quantile(sorted, 0.5);
+	stats.p95 = quantile(sorted, 0.95);
+	stats.ci_low = stats.ci_high = stats.median;
+
+	// Percentile bootstrap of the median; fixed seed so reruns agree
+	if (bootstrap > 0 && sorted.size() > 1){
+		std::mt19937 rng(2018);
+		std::uniform_int_distribution<int> pick(0, sorted.size() - 1);
+		std::vector<double> medians(bootstrap);
+		std::vector<double> resample(sorted.size());
+		for (int b = 0; b < bootstrap; b++){
+			for (size_t i = 0; i < resample.size(); i++)
+				resample[i] = sorted[pick(rng)];
+			std::sort(resample.begin(), resample.end());
+			medians[b] = quantile(resample, 0.5);
+		}
+		std::sort(medians.begin(), medians.end());
+		stats.ci_low = quantile(medians, 0.025);
+		stats.ci_high = quantile(medians, 0.975);
+	}
+
+	stats.rel_error = stats.median > 0 ? 0.5 * (stats.ci_high - stats.ci_low) / stats.median : 0.0;
+	return stats;
+}
+
+// A configuration whose fastest launch is already too slow is not worth more launches
+static bool benchmark_hopeless(const BenchmarkStats& stats, const BenchmarkOptions& options)
+{
+	return options.abort_ms > 0 && stats.reps > 0 && stats.min > options.abort_ms;
+}
+
+bool benchmark_done(const BenchmarkStats& stats, const BenchmarkOptions& options)
+{
+	if (benchmark_hopeless(stats, options))
+		return true;
+	if (stats.reps >= options.max_reps)
+		return true;
+	if (stats.reps < options.min_reps)
+		return false;
+	return stats.rel_error <= options.target_rel_error;
+}
+
+void print_stats(const BenchmarkStats& stats)
+{
+	printf("	Timings (ms): median %.3f, min %.3f, mean %.3f, stddev %.3f, p95 %.3f\n",
+		   stats.median, stats.min, stats.mean, stats.stddev, stats.p95);
+	printf("	95%% CI of median (ms): [%.3f, %.3f], relative error %.1f%% over %d runs\n",
+		   stats.ci_low, stats.ci_high, 100.0 * stats.rel_error, stats.reps);
+}
+
+// Kernel time of one finished launch in milliseconds
+static cl_int event_ms(cl_event event, double& ms)
+{
+	// The unsigned 64-bit values returned can be used to measure the time in nano-seconds consumed by OpenCL commands.
+	cl_ulong start_time, end_time;
+	cl_int err;
+	err  = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &start_time, NULL);
+	err |= clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &end_time, NULL);
+
+	if (err != CL_SUCCESS){
+		if 		(err == CL_PROFILING_INFO_NOT_AVAILABLE) {
+				std::cerr << "	Error. Cl profiling info not available! " << std::endl; }
+		else if (err == CL_INVALID_VALUE) {
+				std::cerr << "	Error. Cl invalid value! " << std::endl; }
+		else if (err == CL_INVALID_EVENT) {
+				std::cerr << "	Error. Cl invalid event! " << std::endl; }
+		else {
+				std::cerr << "	Error. Timing Error!" << err <<std::endl; }
+		return err;
+	}
+
+	// time in milliseconds
+	ms = (double)(end_time - start_time)/1000000.0;
+	return CL_SUCCESS;
+}
+
+cl_int benchmark_kernel(cl_command_queue queue, cl_kernel kernel, const cl_uint dims,
+						const size_t* global, const size_t* local,
+						const BenchmarkOptions& options, BenchmarkStats& stats)
+{
+	cl_int err = CL_SUCCESS;
+	int warmup = options.warmup;
+	std::vector<double> samples;
+
+	// With a cutoff the first warm-up launch is timed, so a kernel far slower than the
+	// cutoff runs once instead of warmup + min_reps times
+	if (options.abort_ms > 0 && warmup > 0){
+		cl_event event = NULL;
+		if ((err = clEnqueueNDRangeKernel(queue, kernel, dims, NULL, global, local, 0, NULL, &event)) != CL_SUCCESS){
+			std::cerr << "	Error. Failed to execute kernel!" << err << std::endl;
+			return err;
+		}
+		double ms = 0;
+		if ((err = clWaitForEvents(1, &event)) == CL_SUCCESS)
+			err = event_ms(event, ms);
+		clReleaseEvent(event);
+		if (err != CL_SUCCESS)
+			return err;
+		if (ms > options.abort_ms){
+			samples.push_back(ms);
+			stats = summarize(samples, 0);
+			stats.aborted = true;
+			return CL_SUCCESS;
+		}
+		warmup--;
+	}
+
+	for (int run = 0; run < warmup; run++){
+		if ((err = clEnqueueNDRangeKernel(queue, kernel, dims, NULL, global, local, 0, NULL, NULL)) != CL_SUCCESS){
+			std::cerr << "	Error. Failed to execute kernel!" << err << std::endl;
+			return err;
+		}
+	}
+	if (warmup > 0 && (err = clFinish(queue)) != CL_SUCCESS){
+		std::cerr << "	Error. Waiting for kernel!" << err << std::endl;
+		return err;
+	}
+
+	return benchmark_more(queue, kernel, dims, global, local, options, samples, stats);
+}
+
+cl_int benchmark_more(cl_command_queue queue, cl_kernel kernel, const cl_uint dims,
+					  const size_t* global, const size_t* local,
+					  const BenchmarkOptions& options, std::vector<double>& samples,
+					  BenchmarkStats& stats)
+{
+	cl_int err = CL_SUCCESS;
+	stats = summarize(samples, options.bootstrap);
+
+	while (!benchmark_done(stats, options)){
+		cl_event event = NULL;
+		if ((err = clEnqueueNDRangeKernel(queue, kernel, dims, NULL, global, local, 0, NULL, &event)) != CL_SUCCESS){
+			std::cerr << "	Error. Failed to execute kernel!" << err << std::endl;
+			return err;
+		}
+		if ((err = clFinish(queue)) != CL_SUCCESS){
+			std::cerr << "	Error. Waiting for kernel!" << err << std::endl;
+			clReleaseEvent(event);
+			return err;
+		}
+
+		double ms;
+		err = event_ms(event, ms);
+		clReleaseEvent(event);
+		if (err != CL_SUCCESS)
+			return err;
+
+		samples.push_back(ms);
+		stats = summarize(samples, options.bootstrap);
+	}
+	stats.aborted = benchmark_hopeless(stats, options);
+	return CL_SUCCESS;
+}
+
+cl_int enqueue_launches(cl_command_queue queue, cl_kernel kernel, const cl_uint dims,
+						const size_t* global, const size_t* local, const int count,
+						const cl_uint num_wait, const cl_event* wait_list,
+						std::vector<cl_event>& events)
+{
+	for (int run = 0; run < count; run++){
+		cl_event event = NULL;
+		cl_int err = clEnqueueNDRangeKernel(queue, kernel, dims, NULL, global, local,
+											run == 0 ? num_wait : 0, run == 0 ? wait_list : NULL, &event);
+		if (err != CL_SUCCESS){
+			std::cerr << "	Error. Failed to execute kernel!" << err << std::endl;
+			return err;
+		}
+		events.push_back(event);
+	}
+	return CL_SUCCESS;
+}
+
+cl_int event_times(const std::vector<cl_event>& events, std::vector<double>& ms)
+{
+	ms.resize(events.size());
+	for (size_t i = 0; i < events.size(); i++){
+		cl_int err = event_ms(events[i], ms[i]);
+		if (err != CL_SUCCESS)
+			return err;
+	}
+	return CL_SUCCESS;
+}
+
+double drain_events(std::vector<cl_event>& events)
+{
+	double total = 0.0;
+	if (!events.empty())
+		clWaitForEvents(events.size(), events.data());
+	for (size_t i = 0; i < events.size(); i++){
+		double ms;
+		if (event_ms(events[i], ms) == CL_SUCCESS)
+			total += ms;
+		clReleaseEvent(events[i]);
+	}
+	events.clear();
+	return total;
+}
+
+double elapsed_ms(const std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
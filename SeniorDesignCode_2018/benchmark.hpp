@@ -0,0 +1,114 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: benchmark.hpp
+//	Purpose of File: Header File for benchmark.cpp
+//
+/****************************************************************************************/
+
+#ifndef BENCHMARK
+#define BENCHMARK
+
+#include <chrono>
+#include <vector>
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+// How many times a kernel is launched to time it
+struct BenchmarkOptions {
+	int 	warmup;				// untimed launches first (JIT, caches, clocks ramping up)
+	int 	min_reps;			// timed launches before the error is checked
+	int 	max_reps;			// timed launches at most
+	double 	target_rel_error;	// stop once the CI half-width is below this fraction
+								// of the median
+	int 	bootstrap;			// resamples for the confidence interval
+	double 	abort_ms;			// stop once the fastest launch is slower than this, 0 never;
+								// the first warm-up launch is timed for it
+};
+
+BenchmarkOptions default_benchmark_options();
+
+// One launch, untimed warm-up, as the host code did before repetitions
+BenchmarkOptions single_run_options();
+
+// Where the time of one multiply goes, in milliseconds. Transfers and the kernel come from
+// the profiling events of their commands; build and host overhead from the wall clock.
+struct PhaseTimes {
+	double 	build;		// compiling or loading the kernel variant, 0 when the session had it
+	double 	host;		// buffers, padding, arguments and waiting around the commands
+	double 	upload;		// writes or mappings of the inputs
+	double 	kernel;		// one launch (the median of the timed ones)
+	double 	download;	// readback of C
+};
+
+PhaseTimes no_phases();
+
+// Latency of one call once its kernel is built: host, upload, kernel and download
+double end_to_end(const PhaseTimes& phases);
+
+void print_phases(const PhaseTimes& phases);
+
+// Statistics of the timed launches, in milliseconds
+struct BenchmarkStats {
+	int 	reps;
+	double 	min, median, mean, stddev, p95;
+	double 	ci_low, ci_high;	// 95% bootstrap confidence interval of the median
+	double 	rel_error;			// CI half-width over the median
+	bool 	aborted;			// stopped early by abort_ms
+	PhaseTimes phases;			// breakdown of one call, filled in by run_sgemm()
+};
+
+// Summarize a set of timings
+BenchmarkStats summarize(const std::vector<double>& samples, const int bootstrap);
+
+// True when enough repetitions have run for the options, or the launches so far are all
+// slower than options.abort_ms
+bool benchmark_done(const BenchmarkStats& stats, const BenchmarkOptions& options);
+
+void print_stats(const BenchmarkStats& stats);
+
+// Launch an NDRange kernel with its arguments already set: options.warmup untimed
+// launches, then timed launches until benchmark_done()
+cl_int benchmark_kernel(cl_command_queue queue, cl_kernel kernel, const cl_uint dims,
+						const size_t* global, const size_t* local,
+						const BenchmarkOptions& options, BenchmarkStats& stats);
+
+// Timed launches after the ones already in samples, one at a time, until
+// benchmark_done(); samples and stats are updated, stats.aborted included
+cl_int benchmark_more(cl_command_queue queue, cl_kernel kernel, const cl_uint dims,
+					  const size_t* global, const size_t* local,
+					  const BenchmarkOptions& options, std::vector<double>& samples,
+					  BenchmarkStats& stats);
+
+// Enqueue count launches without waiting for them; the first one waits for wait_list.
+// One profiling event per launch is appended to events.
+cl_int enqueue_launches(cl_command_queue queue, cl_kernel kernel, const cl_uint dims,
+						const size_t* global, const size_t* local, const int count,
+						const cl_uint num_wait, const cl_event* wait_list,
+						std::vector<cl_event>& events);
+
+// Kernel time in milliseconds of every finished event
+cl_int event_times(const std::vector<cl_event>& events, std::vector<double>& ms);
+
+// Total profiled time of finished commands in milliseconds; the events are released
+double drain_events(std::vector<cl_event>& events);
+
+// Wall-clock milliseconds since start, for the phases that are host work
+double elapsed_ms(const std::chrono::steady_clock::time_point start);
+
+#endif
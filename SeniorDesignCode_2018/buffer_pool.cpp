@@ -0,0 +1,188 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: buffer_pool.cpp
+//	Function(s): BufferPool::acquire(), BufferPool::release(), BufferPool::acquire_host(),
+//				 BufferPool::release_host(), BufferPool::trim()
+//
+//	Purpose: 	Size-class pool of device buffers and pinned host memory. Creating
+//				and first touching large buffers for every sample costs more than the
+//				kernel at large sizes, so buffers are returned to the pool instead of
+//				released and handed out again to the next request of the same class.
+//
+/****************************************************************************************/
+
+#include "buffer_pool.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+// Round up to 1, 1.25, 1.5 or 1.75 times a power of two (at least 4 KB), so a
+// request wastes at most a fifth of its buffer and nearby shapes share a class
+static size_t size_class(const size_t bytes)
+{
+	size_t base = 4096;
+	while (base * 2 <= bytes)
+		base *= 2;
+	for (int quarter = 4; quarter <= 8; quarter++){
+		size_t size = base / 4 * quarter;
+		if (size >= bytes)
+			return size;
+	}
+	return base * 2;
+}
+
+BufferPool::BufferPool(cl_context context, cl_command_queue queue, const bool zero_copy)
+	: context(context), queue(queue), shared_memory(zero_copy), created(0), reused(0), held(0)
+{
+}
+
+BufferPool::~BufferPool()
+{
+	// Anything still in use belongs to a caller that outlived the session; drop it too
+	std::map<cl_mem, SizeClass>::iterator u;
+	for (u = used_buffers.begin(); u != used_buffers.end(); ++u)
+		free_buffers[u->second].push_back(u->first);
+	used_buffers.clear();
+	std::map<float*, HostBlock>::iterator h;
+	for (h = used_host.begin(); h != used_host.end(); ++h)
+		free_host[h->second.size].push_back(h->second);
+	used_host.clear();
+	trim();
+}
+
+cl_mem BufferPool::acquire(const size_t bytes, const cl_mem_flags flags)
+{
+	SizeClass key(size_class(bytes), flags);
+	std::vector<cl_mem>& list = free_buffers[key];
+	cl_mem buffer = NULL;
+	if (!list.empty()){
+		buffer = list.back();
+		list.pop_back();
+		reused++;
+	}
+	else {
+		cl_int err;
+		buffer = clCreateBuffer(context, flags, key.first, NULL, &err);
+		if (err != CL_SUCCESS || !buffer){
+			// Memory held for other classes may be what is missing
+			trim();
+			buffer = clCreateBuffer(context, flags, key.first, NULL, &err);
+			if (err != CL_SUCCESS || !buffer){
+				std::cerr << "	Error. Failed to allocate device memory!\n";
+				return NULL;
+			}
+		}
+		created++;
+		held += key.first;
+	}
+	used_buffers[buffer] = key;
+	return buffer;
+}
+
+void BufferPool::release(cl_mem buffer)
+{
+	std::map<cl_mem, SizeClass>::iterator found = used_buffers.find(buffer);
+	if (found == used_buffers.end()){
+		clReleaseMemObject(buffer);
+		return;
+	}
+	free_buffers[found->second].push_back(buffer);
+	used_buffers.erase(found);
+}
+
+float* BufferPool::acquire_host(const size_t bytes)
+{
+	size_t size = size_class(bytes);
+	std::vector<HostBlock>& list = free_host[size];
+	HostBlock block;
+	if (!list.empty()){
+		block = list.back();
+		list.pop_back();
+		reused++;
+	}
+	else {
+		// Memory the runtime allocates is page-locked, so DMA reads it in place
+		cl_int err;
+		block.size = size;
+		block.memory = NULL;
+		block.buffer = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, size, NULL, &err);
+		if (err == CL_SUCCESS && block.buffer){
+			block.memory = (float*) clEnqueueMapBuffer(queue, block.buffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE,
+													   0, size, 0, NULL, NULL, &err);
+			if (err != CL_SUCCESS){
+				clReleaseMemObject(block.buffer);
+				block.memory = NULL;
+			}
+		}
+		if (!block.memory){
+			// Plain pageable memory still beats a malloc per sample
+			block.buffer = NULL;
+			block.memory = (float*) malloc(size);
+			if (!block.memory){
+				std::cerr << "	Error. Failed to allocate host memory!\n";
+				return NULL;
+			}
+		}
+		created++;
+		held += size;
+	}
+	used_host[block.memory] = block;
+	return block.memory;
+}
+
+void BufferPool::release_host(float* memory)
+{
+	std::map<float*, HostBlock>::iterator found = used_host.find(memory);
+	if (found == used_host.end())
+		return;
+	free_host[found->second.size].push_back(found->second);
+	used_host.erase(found);
+}
+
+void BufferPool::trim()
+{
+	std::map<SizeClass, std::vector<cl_mem> >::iterator b;
+	for (b = free_buffers.begin(); b != free_buffers.end(); ++b){
+		for (size_t i = 0; i < b->second.size(); i++){
+			clReleaseMemObject(b->second[i]);
+			held -= b->first.first;
+		}
+	}
+	free_buffers.clear();
+
+	std::map<size_t, std::vector<HostBlock> >::iterator h;
+	for (h = free_host.begin(); h != free_host.end(); ++h){
+		for (size_t i = 0; i < h->second.size(); i++){
+			HostBlock& block = h->second[i];
+			if (block.buffer){
+				clEnqueueUnmapMemObject(queue, block.buffer, block.memory, 0, NULL, NULL);
+				clFinish(queue);
+				clReleaseMemObject(block.buffer);
+			}
+			else {
+				free(block.memory);
+			}
+			held -= block.size;
+		}
+	}
+	free_host.clear();
+}
+
+void BufferPool::print_report() const
+{
+	printf("Buffers allocated: %d, reused: %d, %.1f MB held%s\n", created, reused,
+		   held / (1024.0 * 1024.0), shared_memory ? " (zero-copy)" : "");
+}
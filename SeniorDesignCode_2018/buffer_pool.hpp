@@ -0,0 +1,122 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: buffer_pool.hpp
+//	Purpose of File: Header File for buffer_pool.cpp
+//
+/****************************************************************************************/
+
+#ifndef BUFFER_POOL
+#define BUFFER_POOL
+
+#include <map>
+#include <vector>
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+// Device buffers and pinned host memory kept for the life of a Session. Requests are
+// rounded up to a size class (quarter steps between powers of two) and served from
+// the free list of that class, so repeated samples of one shape allocate nothing
+// after the first.
+class BufferPool {
+public:
+	// zero_copy: the device shares host memory, so buffers are mapped instead of copied
+	BufferPool(cl_context context, cl_command_queue queue, const bool zero_copy);
+	~BufferPool();
+
+	bool zero_copy() const 	{ return shared_memory; }
+
+	// Device buffer of at least bytes with the given flags, NULL on failure
+	cl_mem acquire(const size_t bytes, const cl_mem_flags flags = CL_MEM_READ_WRITE);
+	void release(cl_mem buffer);
+
+	// Pinned (CL_MEM_ALLOC_HOST_PTR) host memory of at least bytes, mapped for the life
+	// of the pool, NULL on failure. Transfers from it need no staging copy.
+	float* acquire_host(const size_t bytes);
+	void release_host(float* memory);
+
+	// Buffers created since the pool started, requests served from a free list, and
+	// bytes held on the device and pinned on the host
+	int allocations() const 	{ return created; }
+	int reuses() const 			{ return reused; }
+	size_t bytes_held() const 	{ return held; }
+
+	// Release every buffer not in use
+	void trim();
+
+	void print_report() const;
+
+private:
+	BufferPool(const BufferPool&);
+	BufferPool& operator=(const BufferPool&);
+
+	struct HostBlock {
+		cl_mem 	buffer;
+		float* 	memory;
+		size_t 	size;
+	};
+
+	typedef std::pair<size_t, cl_mem_flags> SizeClass;
+
+	cl_context 			context;
+	cl_command_queue 	queue;
+	bool 				shared_memory;
+	int 				created, reused;
+	size_t 				held;
+
+	std::map<SizeClass, std::vector<cl_mem> > 	free_buffers;
+	std::map<cl_mem, SizeClass> 				used_buffers;
+	std::map<size_t, std::vector<HostBlock> > 	free_host;
+	std::map<float*, HostBlock> 				used_host;
+};
+
+// Buffer from a pool, returned to it when the guard goes out of scope
+class PooledBuffer {
+public:
+	PooledBuffer(BufferPool& pool, const size_t bytes, const cl_mem_flags flags = CL_MEM_READ_WRITE)
+		: pool(pool), buffer(pool.acquire(bytes, flags)) {}
+	~PooledBuffer() 			{ if (buffer) pool.release(buffer); }
+
+	cl_mem get() const 			{ return buffer; }
+
+private:
+	PooledBuffer(const PooledBuffer&);
+	PooledBuffer& operator=(const PooledBuffer&);
+
+	BufferPool& pool;
+	cl_mem 		buffer;
+};
+
+// Pinned host memory from a pool, returned to it when the guard goes out of scope
+class PinnedHost {
+public:
+	PinnedHost(BufferPool& pool, const size_t bytes)
+		: pool(pool), memory(pool.acquire_host(bytes)) {}
+	~PinnedHost() 				{ if (memory) pool.release_host(memory); }
+
+	float* get() const 			{ return memory; }
+
+private:
+	PinnedHost(const PinnedHost&);
+	PinnedHost& operator=(const PinnedHost&);
+
+	BufferPool& pool;
+	float* 		memory;
+};
+
+#endif
@@ -0,0 +1,619 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: cpu_sgemm.cpp
+//	Function(s): cpu_sgemm(), run_cpu_sgemm(), cpu_isa(), make_cpu_config(),
+//				 default_cpu_config(), check_cpu_config(), enumerate_cpu_configs(),
+//				 cpu_config_features(), cpu_thread_counts(), print_cpu_scaling(),
+//				 write_cpu_csv_header(), write_cpu_csv_row()
+//
+//	Purpose: 	SGEMM on the host CPU, blocked the way GotoBLAS does it. B is packed
+//				in KC x NC panels (L3), A in MC x KC blocks (L2), and a micro-kernel
+//				keeps an MR x NR tile of C in registers while it streams one sliver of
+//				each (L1). The micro-kernel is picked at run time from what CPUID
+//				reports, so one binary runs everywhere. MC, NC, KC and the micro-tile
+//				are tuned like the OpenCL kernel parameters. Row blocks and groups of
+//				column slivers are spread over the work-stealing pool of
+//				thread_pool.cpp; the thread count and task grain are tuned as well.
+//
+/****************************************************************************************/
+
+#include "cpu_sgemm.hpp"
+#include "roofline.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_SGEMM_X86
+#include <immintrin.h>
+#endif
+
+// Largest micro-tile of any kernel, for the scratch tile at the edges of C
+static const int MAX_MR = 16;
+static const int MAX_NR = 32;
+
+// C (mr x nr, leading dimension ldc) = or += sum over kc of a sliver of A times a
+// sliver of B. The A sliver is kc columns of mr floats, the B sliver kc rows of nr.
+typedef void (*MicroKernel)(const int kc, const float* a, const float* b,
+							float* c, const int ldc, const bool accumulate);
+
+template <int MR, int NR>
+static void kernel_generic(const int kc, const float* a, const float* b,
+						   float* c, const int ldc, const bool accumulate)
+{
+	float acc[MR][NR] = {};
+	for (int k = 0; k < kc; k++){
+		for (int i = 0; i < MR; i++){
+			for (int j = 0; j < NR; j++)
+				acc[i][j] += a[i] * b[j];
+		}
+		a += MR;
+		b += NR;
+	}
+	for (int i = 0; i < MR; i++){
+		for (int j = 0; j < NR; j++)
+			c[i*ldc + j] = accumulate ? c[i*ldc + j] + acc[i][j] : acc[i][j];
+	}
+}
+
+#ifdef CPU_SGEMM_X86
+
+// NV registers of 8 floats per row of the tile, NR = 8 NV
+template <int MR, int NV>
+__attribute__((target("avx2,fma")))
+static void kernel_avx2(const int kc, const float* a, const float* b,
+						float* c, const int ldc, const bool accumulate)
+{
+	__m256 acc[MR][NV];
+	for (int i = 0; i < MR; i++){
+		for (int v = 0; v < NV; v++)
+			acc[i][v] = _mm256_setzero_ps();
+	}
+	for (int k = 0; k < kc; k++){
+		__m256 bv[NV];
+		for (int v = 0; v < NV; v++)
+			bv[v] = _mm256_loadu_ps(b + 8*v);
+		for (int i = 0; i < MR; i++){
+			__m256 ai = _mm256_broadcast_ss(a + i);
+			for (int v = 0; v < NV; v++)
+				acc[i][v] = _mm256_fmadd_ps(ai, bv[v], acc[i][v]);
+		}
+		a += MR;
+		b += 8*NV;
+	}
+	for (int i = 0; i < MR; i++){
+		for (int v = 0; v < NV; v++){
+			float* p = c + i*ldc + 8*v;
+			_mm256_storeu_ps(p, accumulate ? _mm256_add_ps(acc[i][v], _mm256_loadu_ps(p)) : acc[i][v]);
+		}
+	}
+}
+
+// NV registers of 16 floats per row of the tile, NR = 16 NV
+template <int MR, int NV>
+__attribute__((target("avx512f")))
+static void kernel_avx512(const int kc, const float* a, const float* b,
+						  float* c, const int ldc, const bool accumulate)
+{
+	__m512 acc[MR][NV];
+	for (int i = 0; i < MR; i++){
+		for (int v = 0; v < NV; v++)
+			acc[i][v] = _mm512_setzero_ps();
+	}
+	for (int k = 0; k < kc; k++){
+		__m512 bv[NV];
+		for (int v = 0; v < NV; v++)
+			bv[v] = _mm512_loadu_ps(b + 16*v);
+		for (int i = 0; i < MR; i++){
+			__m512 ai = _mm512_set1_ps(a[i]);
+			for (int v = 0; v < NV; v++)
+				acc[i][v] = _mm512_fmadd_ps(ai, bv[v], acc[i][v]);
+		}
+		a += MR;
+		b += 16*NV;
+	}
+	for (int i = 0; i < MR; i++){
+		for (int v = 0; v < NV; v++){
+			float* p = c + i*ldc + 16*v;
+			_mm512_storeu_ps(p, accumulate ? _mm512_add_ps(acc[i][v], _mm512_loadu_ps(p)) : acc[i][v]);
+		}
+	}
+}
+
+#endif
+
+struct MicroKernelEntry {
+	CpuIsa 		isa;
+	int 		mr, nr;
+	MicroKernel kernel;
+};
+
+// Tiles use at most 12 of the 16 AVX2 registers and 28 of the 32 AVX-512 registers
+// for accumulators, leaving room for the B sliver and the broadcast of A
+static const MicroKernelEntry micro_kernels[] = {
+	{CPU_GENERIC, 4,  4,  kernel_generic<4, 4>},
+	{CPU_GENERIC, 4,  8,  kernel_generic<4, 8>},
+	{CPU_GENERIC, 8,  4,  kernel_generic<8, 4>},
+	{CPU_GENERIC, 8,  8,  kernel_generic<8, 8>},
+#ifdef CPU_SGEMM_X86
+	{CPU_AVX2, 	  4,  8,  kernel_avx2<4, 1>},
+	{CPU_AVX2, 	  8,  8,  kernel_avx2<8, 1>},
+	{CPU_AVX2, 	  4,  16, kernel_avx2<4, 2>},
+	{CPU_AVX2, 	  6,  16, kernel_avx2<6, 2>},
+	{CPU_AVX2, 	  4,  24, kernel_avx2<4, 3>},
+	{CPU_AVX512,  8,  16, kernel_avx512<8, 1>},
+	{CPU_AVX512,  14, 16, kernel_avx512<14, 1>},
+	{CPU_AVX512,  4,  32, kernel_avx512<4, 2>},
+	{CPU_AVX512,  8,  32, kernel_avx512<8, 2>},
+	{CPU_AVX512,  12, 32, kernel_avx512<12, 2>},
+#endif
+};
+
+static const int micro_kernel_count = sizeof(micro_kernels) / sizeof(micro_kernels[0]);
+
+// Micro-kernel of an mr x nr tile the instruction set can run, NULL if there is none
+static MicroKernel find_kernel(CpuIsa isa, int mr, int nr)
+{
+	for (int i = 0; i < micro_kernel_count; i++){
+		if (micro_kernels[i].isa <= isa && micro_kernels[i].mr == mr && micro_kernels[i].nr == nr)
+			return micro_kernels[i].kernel;
+	}
+	return NULL;
+}
+
+static CpuIsa detect_isa()
+{
+	CpuIsa isa = CPU_GENERIC;
+#if defined(CPU_SGEMM_X86) && (defined(__GNUC__) || defined(__clang__))
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		isa = CPU_AVX2;
+	if (isa == CPU_AVX2 && __builtin_cpu_supports("avx512f"))
+		isa = CPU_AVX512;
+#endif
+
+	// Lower the instruction set to compare micro-kernels on the same machine
+	const char* limit = getenv("OCLSGEMM_CPU_ISA");
+	if (limit){
+		if (strcmp(limit, "generic") == 0)
+			isa = CPU_GENERIC;
+		else if (strcmp(limit, "avx2") == 0 && isa > CPU_AVX2)
+			isa = CPU_AVX2;
+	}
+	return isa;
+}
+
+CpuIsa cpu_isa()
+{
+	static const CpuIsa isa = detect_isa();
+	return isa;
+}
+
+const char* cpu_isa_name(CpuIsa isa)
+{
+	switch (isa){
+		case CPU_AVX2: 		return "AVX2";
+		case CPU_AVX512: 	return "AVX-512";
+		default: 			return "generic";
+	}
+}
+
+CpuConfig make_cpu_config(int mc, int nc, int kc, int mr, int nr, int threads, int grain)
+{
+	CpuConfig config;
+	config.mc = mc;
+	config.nc = nc;
+	config.kc = kc;
+	config.mr = mr;
+	config.nr = nr;
+	config.threads = threads;
+	config.grain = grain;
+	return config;
+}
+
+CpuConfig default_cpu_config(CpuIsa isa)
+{
+	if (isa == CPU_AVX512)
+		return make_cpu_config(96, 4096, 256, 12, 32);
+	if (isa == CPU_AVX2)
+		return make_cpu_config(96, 4096, 256, 6, 16);
+	return make_cpu_config(96, 1024, 256, 8, 8);
+}
+
+bool check_cpu_config(const CpuConfig& config, CpuIsa isa, int display)
+{
+	if (config.mc <= 0 || config.nc <= 0 || config.kc <= 0){
+		if (display)
+			std::cerr << "	Error. MC, NC and KC must be positive!" << std::endl;
+		return false;
+	}
+	if (config.threads < 0 || config.grain < 0){
+		if (display)
+			std::cerr << "	Error. Threads and grain cannot be negative!" << std::endl;
+		return false;
+	}
+	if (!find_kernel(isa, config.mr, config.nr)){
+		if (display)
+			std::cerr << "	Error. No " << config.mr << "x" << config.nr << " micro-kernel for "
+					  << cpu_isa_name(isa) << "!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+std::vector<int> cpu_thread_counts()
+{
+	int cores = available_cores();
+	std::vector<int> counts;
+	for (int t = 1; t < cores; t *= 2)
+		counts.push_back(t);
+	counts.push_back(cores);
+	return counts;
+}
+
+void enumerate_cpu_configs(CpuIsa isa, std::vector<CpuConfig>& configs)
+{
+	static const int mc_sizes[] = {48, 96, 192};
+	static const int nc_sizes[] = {512, 1024, 4096};
+	static const int kc_sizes[] = {128, 256, 384};
+	static const int grains[]   = {0, 4, 16};
+	std::vector<int> threads = cpu_thread_counts();
+
+	configs.clear();
+	for (int t = 0; t < micro_kernel_count; t++){
+		if (micro_kernels[t].isa != isa)
+			continue;
+		for (int m = 0; m < 3; m++)
+		for (int n = 0; n < 3; n++)
+		for (int k = 0; k < 3; k++)
+		for (size_t p = 0; p < threads.size(); p++)
+		for (int g = 0; g < 3; g++){
+			// The grain only matters when there are workers to share a panel
+			if (threads[p] == 1 && grains[g] != 0)
+				continue;
+			configs.push_back(make_cpu_config(mc_sizes[m], nc_sizes[n], kc_sizes[k],
+											  micro_kernels[t].mr, micro_kernels[t].nr,
+											  threads[p], grains[g]));
+		}
+	}
+}
+
+std::vector<double> cpu_config_features(const int M, const int N, const int K, const CpuConfig& config)
+{
+	std::vector<double> x(10);
+	x[0] = M;
+	x[1] = N;
+	x[2] = K;
+	x[3] = config.mc;
+	x[4] = config.nc;
+	x[5] = config.kc;
+	x[6] = config.mr;
+	x[7] = config.nr;
+	x[8] = config.threads > 0 ? config.threads : available_cores();
+	x[9] = config.grain;
+	return x;
+}
+
+void print_cpu_inputs(const int M, const int N, const int K, const CpuConfig& config)
+{
+	printf("	Inputs:  [%d, %d, %d, %d, %d, %d, %d, %d, %d, %d]\n", M, N, K,
+		   config.mc, config.nc, config.kc, config.mr, config.nr, config.threads, config.grain);
+}
+
+void write_cpu_csv_header(std::ofstream& csv)
+{
+	csv << "Time" << ",";
+	csv << "M" << ",";
+	csv << "N" << ",";
+	csv << "K" << ",";
+	csv << "MC" << ",";
+	csv << "NC" << ",";
+	csv << "KC" << ",";
+	csv << "MR" << ",";
+	csv << "NR" << ",";
+	csv << "Threads" << ",";
+	csv << "Grain" << "\n";
+}
+
+void write_cpu_csv_row(std::ofstream& csv, const double time,
+					   const int M, const int N, const int K, const CpuConfig& config)
+{
+	csv << time << ",";
+	csv << M << ",";
+	csv << N << ",";
+	csv << K << ",";
+	csv << config.mc << ",";
+	csv << config.nc << ",";
+	csv << config.kc << ",";
+	csv << config.mr << ",";
+	csv << config.nr << ",";
+	csv << config.threads << ",";
+	csv << config.grain << "\n";
+}
+
+// Pack rows x depth of A into slivers of mr rows, each stored column by column and
+// zero-padded to a whole sliver
+static void pack_a(const int rows, const int depth, const float* A, const int lda,
+				   const int mr, float* packed)
+{
+	for (int i0 = 0; i0 < rows; i0 += mr){
+		int height = std::min(mr, rows - i0);
+		for (int k = 0; k < depth; k++){
+			for (int i = 0; i < height; i++)
+				packed[i] = A[(size_t) (i0 + i)*lda + k];
+			for (int i = height; i < mr; i++)
+				packed[i] = 0.0f;
+			packed += mr;
+		}
+	}
+}
+
+// Pack depth x cols of B into slivers of nr columns, each stored row by row and
+// zero-padded to a whole sliver
+static void pack_b(const int depth, const int cols, const float* B, const int ldb,
+				   const int nr, float* packed)
+{
+	for (int j0 = 0; j0 < cols; j0 += nr){
+		int width = std::min(nr, cols - j0);
+		for (int k = 0; k < depth; k++){
+			memcpy(packed, B + (size_t) k*ldb + j0, sizeof(float) * width);
+			for (int j = width; j < nr; j++)
+				packed[j] = 0.0f;
+			packed += nr;
+		}
+	}
+}
+
+static int round_up(int value, int step)
+{
+	return ((value + step - 1) / step) * step;
+}
+
+// Block of A packed by one worker. It is allocated, and so first touched, by the
+// pinned worker itself and stays on that worker's NUMA node for later calls. The
+// block only depends on ic and pc, so it is reused across column panels.
+struct PackedBlock {
+	std::vector<float> 	data;
+	long long 			call;	// cpu_sgemm() call, row block and depth it holds
+	int 				ic, pc;
+};
+
+static thread_local PackedBlock packed_block = {std::vector<float>(), -1, 0, 0};
+static std::atomic<long long> sgemm_calls(0);
+
+// Multiply one task: rows [ic, ic + rows) of the panel against the column slivers
+// [first, last) of the packed B
+static void multiply_block(MicroKernel kernel, const int mr, const int nr,
+						   const float* a_block, const float* b_panel, const int depth,
+						   const int rows, const int cols, const int first, const int last,
+						   float* C, const int ldc, const bool accumulate)
+{
+	float edge[MAX_MR * MAX_NR];
+
+	// The B sliver stays in L1 while every A sliver of the block passes it
+	for (int s = first; s < last; s++){
+		const int jr = s*nr;
+		const int width = std::min(nr, cols - jr);
+		const float* b = b_panel + (size_t) jr*depth;
+		for (int ir = 0; ir < rows; ir += mr){
+			const int height = std::min(mr, rows - ir);
+			const float* a = a_block + (size_t) ir*depth;
+			float* c = C + (size_t) ir*ldc + jr;
+
+			if (height == mr && width == nr){
+				kernel(depth, a, b, c, ldc, accumulate);
+				continue;
+			}
+
+			// Partial tile: compute it whole, keep the part inside C
+			kernel(depth, a, b, edge, nr, false);
+			for (int i = 0; i < height; i++){
+				for (int j = 0; j < width; j++)
+					c[(size_t) i*ldc + j] = accumulate ? c[(size_t) i*ldc + j] + edge[i*nr + j] : edge[i*nr + j];
+			}
+		}
+	}
+}
+
+int cpu_sgemm(const CpuConfig& config, CpuIsa isa,
+			  const int M, const int N, const int K,
+			  const float* A, const int lda,
+			  const float* B, const int ldb,
+			  float* C, const int ldc)
+{
+	if (!check_cpu_config(config, isa))
+		return -1;
+	MicroKernel kernel = find_kernel(isa, config.mr, config.nr);
+	const int mr = config.mr, nr = config.nr;
+	if (M <= 0 || N <= 0)
+		return 0;
+
+	if (K <= 0){
+		for (int i = 0; i < M; i++)
+			std::fill(C + (size_t) i*ldc, C + (size_t) i*ldc + N, 0.0f);
+		return 0;
+	}
+
+	ThreadPool& pool = cpu_thread_pool(config.threads);
+	const long long call = sgemm_calls++;
+
+	// Blocks never need to be larger than the matrices
+	const int mc = std::min(config.mc, round_up(M, mr));
+	const int nc = std::min(config.nc, round_up(N, nr));
+	const int kc = std::min(config.kc, K);
+
+	// Left uninitialized so the pages are first touched by the workers that pack them
+	std::unique_ptr<float[]> packed_b(new float[(size_t) round_up(nc, nr) * kc]);
+
+	for (int jc = 0; jc < N; jc += nc){
+		const int cols = std::min(nc, N - jc);
+		const int slivers = (cols + nr - 1) / nr;
+		const int grain = config.grain > 0 ? std::min(config.grain, slivers) : slivers;
+		const int chunks = (slivers + grain - 1) / grain;
+		const int row_blocks = (M + mc - 1) / mc;
+
+		for (int pc = 0; pc < K; pc += kc){
+			const int depth = std::min(kc, K - pc);
+			const bool accumulate = pc > 0;
+			const float* B_panel = B + (size_t) pc*ldb + jc;
+
+			// Every worker packs a share of the B slivers
+			pool.parallel_for(slivers, [&](int s, int) {
+				pack_b(depth, std::min(nr, cols - s*nr), B_panel + s*nr, ldb, nr,
+					   packed_b.get() + (size_t) s*nr*depth);
+			});
+
+			// One task per MC row block and grain of slivers. Neighbouring tasks share
+			// the row block, so a worker packs its A block once for its whole range.
+			pool.parallel_for(row_blocks * chunks, [&](int t, int) {
+				const int ic = (t / chunks) * mc;
+				const int chunk = t % chunks;
+				const int rows = std::min(mc, M - ic);
+
+				PackedBlock& block = packed_block;
+				if (block.call != call || block.ic != ic || block.pc != pc){
+					size_t size = (size_t) round_up(mc, mr) * kc;
+					if (block.data.size() < size)
+						block.data.resize(size);
+					pack_a(rows, depth, A + (size_t) ic*lda + pc, lda, mr, &block.data[0]);
+					block.call = call;
+					block.ic = ic;
+					block.pc = pc;
+				}
+
+				multiply_block(kernel, mr, nr, &block.data[0], packed_b.get(), depth, rows, cols,
+							   chunk*grain, std::min(slivers, (chunk + 1)*grain),
+							   C + (size_t) ic*ldc + jc, ldc, accumulate);
+			});
+		}
+	}
+	return 0;
+}
+
+// Warm-up runs, then timed runs until the median is stable
+static BenchmarkStats time_cpu_sgemm(const CpuConfig& config, CpuIsa isa,
+									 const int M, const int N, const int K,
+									 const float* A, const float* B, float* C,
+									 const BenchmarkOptions& options)
+{
+	std::vector<double> samples;
+	BenchmarkStats result = summarize(samples, 0);
+	for (int run = 0; run < options.warmup || !benchmark_done(result, options); run++){
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		cpu_sgemm(config, isa, M, N, K, A, K, B, N, C, N);
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		if (run >= options.warmup){
+			samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			result = summarize(samples, options.bootstrap);
+		}
+	}
+	return result;
+}
+
+static void seed_matrices(std::vector<float>& A, std::vector<float>& B)
+{
+	std::mt19937 rng(2018);
+	std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+	for (size_t i = 0; i < A.size(); i++)
+		A[i] = uniform(rng);
+	for (size_t i = 0; i < B.size(); i++)
+		B[i] = uniform(rng);
+}
+
+double run_cpu_sgemm(const int M, const int N, const int K,
+					 const CpuConfig& config, CpuIsa isa,
+					 const BenchmarkOptions* bench, BenchmarkStats* stats,
+					 const VerifyOptions* verify)
+{
+	std::cout << " Size of M x N x K: " 		<< M << "x" << N << "x" << K << std::endl;
+	std::cout << " Instruction set: " 			<< cpu_isa_name(isa) << std::endl;
+	std::cout << " Blocks MC x NC x KC: " 		<< config.mc << "x" << config.nc << "x" << config.kc << std::endl;
+	std::cout << " Micro-tile: " 				<< config.mr << "x" << config.nr << std::endl;
+	std::cout << " Threads: " 					<< (config.threads > 0 ? config.threads : available_cores())
+			  << ", grain: " << config.grain << std::endl;
+
+	if (M <= 0 || N <= 0 || K <= 0){
+		std::cout << "	Matrix dimensions must be positive!" << std::endl;
+		return -1;
+	}
+	if (!check_cpu_config(config, isa))
+		return -1;
+
+	std::vector<float> A((size_t) M * K), B((size_t) K * N), C((size_t) M * N);
+	seed_matrices(A, B);
+
+	std::cout << "	Running matrix multiplication for matrices A (" << M
+			  << "x" << K << ")  and B (" << K << "x" << N << ") ...\n";
+
+	BenchmarkOptions options = bench ? *bench : single_run_options();
+	BenchmarkStats result = time_cpu_sgemm(config, isa, M, N, K, &A[0], &B[0], &C[0], options);
+
+	double time = result.median;
+	std::cout << "	Execution Time (msec): " << time << std::endl;
+	printf("	Throughput: %.2f GFLOP/s, %.2f GB/s effective\n",
+		   sgemm_gflops(M, N, K, time), sgemm_bandwidth(M, N, K, time));
+	if (result.reps > 1)
+		print_stats(result);
+	if (stats)
+		*stats = result;
+
+	VerifyOptions check = verify ? *verify : default_verify_options(VERIFY_FULL);
+	VerifyResult verified = verify_sgemm(check, M, N, K, &A[0], K, &B[0], N, &C[0], N);
+	if (!verified.passed){
+		printf("	The CPU matrix is not equal (error %.2f times the rounding bound)\n", verified.max_error);
+		return -1;
+	}
+	if (check.mode != VERIFY_NONE){
+		printf("	The matrices are equal! (%s check, error %.2f of the rounding bound)\n",
+			   verify_mode_name(check.mode), verified.max_error);
+	}
+	printf("	Verification time is %f milliseconds\n", verified.ms);
+	return time;
+}
+
+void print_cpu_scaling(const int M, const int N, const int K, const CpuConfig& config,
+					   CpuIsa isa, const BenchmarkOptions& bench)
+{
+	if (M <= 0 || N <= 0 || K <= 0 || !check_cpu_config(config, isa))
+		return;
+
+	std::vector<float> A((size_t) M * K), B((size_t) K * N), C((size_t) M * N);
+	seed_matrices(A, B);
+
+	printf("\nScaling of %d x %d x %d on %d cores\n==========================\n",
+		   M, N, K, available_cores());
+	printf("	Threads	Time (ms)	GFLOP/s	Speedup	Efficiency\n");
+
+	std::vector<int> counts = cpu_thread_counts();
+	double single = -1;
+	for (size_t i = 0; i < counts.size(); i++){
+		CpuConfig run = config;
+		run.threads = counts[i];
+		double time = time_cpu_sgemm(run, isa, M, N, K, &A[0], &B[0], &C[0], bench).median;
+		if (single < 0)
+			single = time;
+		double speedup = time > 0 ? single / time : 0.0;
+		printf("	%d	%.3f		%.2f	%.2fx	%.0f%%\n", counts[i], time,
+			   sgemm_gflops(M, N, K, time), speedup, 100.0 * speedup / counts[i]);
+	}
+}
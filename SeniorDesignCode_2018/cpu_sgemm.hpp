@@ -0,0 +1,95 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: cpu_sgemm.hpp
+//	Purpose of File: Header File for cpu_sgemm.cpp
+//
+/****************************************************************************************/
+
+#ifndef CPU_SGEMM
+#define CPU_SGEMM
+
+#include <fstream>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "verify.hpp"
+
+// Instruction sets with micro-kernels, in increasing order
+enum CpuIsa {
+	CPU_GENERIC,	// plain C++, vectorized by the compiler
+	CPU_AVX2,		// AVX2 + FMA, 8 floats per register
+	CPU_AVX512		// AVX-512F, 16 floats per register
+};
+
+// Best instruction set of this CPU. OCLSGEMM_CPU_ISA=generic|avx2|avx512 lowers it.
+CpuIsa cpu_isa();
+const char* cpu_isa_name(CpuIsa isa);
+
+// Blocking of the packed CPU SGEMM
+struct CpuConfig {
+	int mc;		// rows of A packed per block, sized for L2
+	int nc;		// columns of B packed per panel, sized for L3
+	int kc;		// depth of both packed blocks, sized so a micro-panel of B stays in L1
+	int mr, nr;	// C micro-tile kept in registers
+	int threads;	// workers of the thread pool, 0 = every core
+	int grain;		// NR-wide column slivers per task, 0 = the whole NC panel
+};
+
+CpuConfig make_cpu_config(int mc, int nc, int kc, int mr, int nr, int threads = 0, int grain = 0);
+
+// Micro-tile and blocking that suit the instruction set
+CpuConfig default_cpu_config(CpuIsa isa);
+
+// True when every block is positive and the instruction set has an mr x nr micro-kernel
+bool check_cpu_config(const CpuConfig& config, CpuIsa isa, int display = 1);
+
+// Every configuration of the CPU search space for the instruction set
+void enumerate_cpu_configs(CpuIsa isa, std::vector<CpuConfig>& configs);
+
+// Thread counts tried by the search and the scaling curve: powers of two up to the
+// number of cores, and the number of cores itself
+std::vector<int> cpu_thread_counts();
+
+// Model inputs of one CPU sample: M, N, K, MC, NC, KC, MR, NR, Threads, Grain
+std::vector<double> cpu_config_features(const int M, const int N, const int K, const CpuConfig& config);
+
+void print_cpu_inputs(const int M, const int N, const int K, const CpuConfig& config);
+
+// Columns of cpu_dataset.csv: Time, then the inputs of cpu_config_features()
+void write_cpu_csv_header(std::ofstream& csv);
+void write_cpu_csv_row(std::ofstream& csv, const double time,
+					   const int M, const int N, const int K, const CpuConfig& config);
+
+// C = A * B on the CPU for row-major A (M x K), B (K x N) and C (M x N) with leading
+// dimensions. Returns 0, or -1 when the configuration has no micro-kernel.
+int cpu_sgemm(const CpuConfig& config, CpuIsa isa,
+			  const int M, const int N, const int K,
+			  const float* A, const int lda,
+			  const float* B, const int ldb,
+			  float* C, const int ldc);
+
+// Time the configuration on 1 to every core and print time, GFLOP/s, speedup and
+// parallel efficiency for each thread count
+void print_cpu_scaling(const int M, const int N, const int K, const CpuConfig& config,
+					   CpuIsa isa, const BenchmarkOptions& bench);
+
+// Time cpu_sgemm() on random M x N x K matrices and check the result, like host() does
+// for the kernels. Returns the median time in milliseconds, -1 on failure.
+double run_cpu_sgemm(const int M, const int N, const int K,
+					 const CpuConfig& config, CpuIsa isa,
+					 const BenchmarkOptions* bench = NULL, BenchmarkStats* stats = NULL,
+					 const VerifyOptions* verify = NULL);
+
+#endif
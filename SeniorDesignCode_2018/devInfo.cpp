@@ -16,11 +16,148 @@
 //	
 //	Purpose: 	The file contains functions that help to display information about
 //				about the available OpenCL devices and detailed information about each
-//				device.
+//				device. device_inventory() returns the same information as structs, so
+//				the tuner can rule out configurations a device cannot launch and the
+//				performance model can tell devices apart.
 //
 /****************************************************************************************/
 
 #include "devInfo.hpp"
+#include "session.hpp"
+
+
+bool query_device(cl_device_id device, DeviceInfo& info){
+	
+	char device_string[1024];
+	cl_int err = CL_SUCCESS;
+	
+	info.id = device;
+	
+	err |= clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(device_string), &device_string, NULL);
+	info.name = err == CL_SUCCESS ? device_string : "";
+	clGetDeviceInfo(device, CL_DEVICE_VENDOR, sizeof(device_string), &device_string, NULL);
+	info.vendor = device_string;
+	clGetDeviceInfo(device, CL_DRIVER_VERSION, sizeof(device_string), &device_string, NULL);
+	info.driver = device_string;
+	
+	// Same key the tuning database stores, so it cannot hold commas
+	info.identity = info.name + " / " + info.driver;
+	for (size_t i = 0; i < info.identity.size(); i++){
+		if (info.identity[i] == ',' || info.identity[i] == '\n')
+			info.identity[i] = ';';
+	}
+	
+	cl_uint value = 0;
+	cl_ulong size = 0;
+	cl_bool flag = CL_FALSE;
+	cl_device_local_mem_type local_mem_type = CL_GLOBAL;
+	
+	info.type = CL_DEVICE_TYPE_DEFAULT;
+	err |= clGetDeviceInfo(device, CL_DEVICE_TYPE, sizeof(info.type), &info.type, NULL);
+	
+	clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(value), &value, NULL);
+	info.compute_units = value;
+	value = 0;
+	clGetDeviceInfo(device, CL_DEVICE_MAX_CLOCK_FREQUENCY, sizeof(value), &value, NULL);
+	info.clock_mhz = value;
+	
+	info.global_mem = info.max_alloc = info.local_mem = info.constant_mem = 0;
+	clGetDeviceInfo(device, CL_DEVICE_GLOBAL_MEM_SIZE, sizeof(size), &size, NULL);
+	info.global_mem = size;
+	clGetDeviceInfo(device, CL_DEVICE_MAX_MEM_ALLOC_SIZE, sizeof(size), &size, NULL);
+	info.max_alloc = size;
+	size = 0;
+	clGetDeviceInfo(device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(size), &size, NULL);
+	info.local_mem = size;
+	clGetDeviceInfo(device, CL_DEVICE_LOCAL_MEM_TYPE, sizeof(local_mem_type), &local_mem_type, NULL);
+	info.dedicated_local = local_mem_type == CL_LOCAL;
+	size = 0;
+	clGetDeviceInfo(device, CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE, sizeof(size), &size, NULL);
+	info.constant_mem = size;
+	
+	info.max_work_group = 0;
+	err |= clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(info.max_work_group), &info.max_work_group, NULL);
+	info.work_item_dims = 0;
+	clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS, sizeof(info.work_item_dims), &info.work_item_dims, NULL);
+	info.max_work_item[0] = info.max_work_item[1] = info.max_work_item[2] = info.max_work_group;
+	if (info.work_item_dims >= 3)
+		clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_ITEM_SIZES, sizeof(info.max_work_item), &info.max_work_item, NULL);
+	
+	value = 1;
+	clGetDeviceInfo(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT, sizeof(value), &value, NULL);
+	info.vector_width = value;
+	value = 1;
+	clGetDeviceInfo(device, CL_DEVICE_NATIVE_VECTOR_WIDTH_FLOAT, sizeof(value), &value, NULL);
+	info.native_vector_width = value;
+	
+	clGetDeviceInfo(device, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(flag), &flag, NULL);
+	info.unified_memory = flag == CL_TRUE;
+	
+	info.queue_properties = 0;
+	clGetDeviceInfo(device, CL_DEVICE_QUEUE_PROPERTIES, sizeof(info.queue_properties), &info.queue_properties, NULL);
+	
+	return err == CL_SUCCESS;
+}
+
+
+const std::vector<DeviceInfo>& device_inventory(){
+	
+	// Built on first use; later calls only read it
+	static const std::vector<DeviceInfo> inventory = [](){
+		std::vector<DeviceInfo> devices;
+		std::vector<cl_device_id> ids = opencl_devices();
+		for (size_t i = 0; i < ids.size(); i++){
+			DeviceInfo info;
+			if (query_device(ids[i], info))
+				devices.push_back(info);
+		}
+		return devices;
+	}();
+	return inventory;
+}
+
+
+const DeviceInfo* find_device(cl_device_id device){
+	
+	const std::vector<DeviceInfo>& devices = device_inventory();
+	for (size_t i = 0; i < devices.size(); i++){
+		if (devices[i].id == device)
+			return &devices[i];
+	}
+	return NULL;
+}
+
+
+const DeviceInfo* find_device(const std::string& identity){
+	
+	const std::vector<DeviceInfo>& devices = device_inventory();
+	for (size_t i = 0; i < devices.size(); i++){
+		if (devices[i].identity == identity)
+			return &devices[i];
+	}
+	return NULL;
+}
+
+
+std::vector<double> device_features(const DeviceInfo& info){
+	
+	std::vector<double> x(6);
+	x[0] = info.compute_units;
+	x[1] = info.clock_mhz;
+	x[2] = info.local_mem / 1024.0;
+	x[3] = info.max_work_group;
+	x[4] = info.vector_width;
+	x[5] = (info.type & CL_DEVICE_TYPE_GPU) ? 1 : 0;
+	return x;
+}
+
+
+std::vector<std::string> device_feature_names(){
+	
+	static const char* names[] = {"Compute_Units", "Clock_MHz", "Local_Mem_KB",
+								  "Max_Work_Group", "Device_Vector_Width", "Is_GPU"};
+	return std::vector<std::string>(names, names + 6);
+}
 
 
 void clPrintDevInfo(cl_device_id device){
@@ -155,8 +292,8 @@ void clPrintDevInfo(cl_device_id device){
 	clGetDeviceInfo(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_LONG, sizeof(cl_uint), &vec_width[3], NULL);
 	clGetDeviceInfo(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT, sizeof(cl_uint), &vec_width[4], NULL);
 	clGetDeviceInfo(device, CL_DEVICE_PREFERRED_VECTOR_WIDTH_DOUBLE, sizeof(cl_uint), &vec_width[5], NULL);
-	printf("CHAR %u, SHORT %u, INT %u, FLOAT %u, DOUBLE %u\n\n\n",
-			vec_width[0], vec_width[1], vec_width[2], vec_width[3], vec_width[4]);
+	printf("CHAR %u, SHORT %u, INT %u, LONG %u, FLOAT %u, DOUBLE %u\n\n\n",
+			vec_width[0], vec_width[1], vec_width[2], vec_width[3], vec_width[4], vec_width[5]);
 }
 
 
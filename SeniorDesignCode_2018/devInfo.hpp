@@ -24,6 +24,8 @@
 
 #include <sstream>
 #include <fstream>
+#include <string>
+#include <vector>
 
 #ifdef __APPLE__
 #include <OpenCL/opencl.h>	// Compiler Flag: -framework OpenCL
@@ -34,6 +36,43 @@
 #ifndef devInfo_H
 #define devInfo_H
 
+// Capabilities of one OpenCL device, probed once by device_inventory()
+struct DeviceInfo {
+	cl_device_id 	id;
+	std::string 	name;
+	std::string 	vendor;
+	std::string 	driver;
+	std::string 	identity;			// "name / driver", the key of tuned results
+	cl_device_type 	type;
+	int 			compute_units;
+	int 			clock_mhz;
+	cl_ulong 		global_mem;			// bytes
+	cl_ulong 		max_alloc;			// largest single buffer, bytes
+	cl_ulong 		local_mem;			// bytes per work-group
+	bool 			dedicated_local;	// CL_LOCAL rather than carved out of global memory
+	cl_ulong 		constant_mem;		// bytes
+	size_t 			max_work_group;
+	cl_uint 		work_item_dims;
+	size_t 			max_work_item[3];
+	int 			vector_width;		// CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT
+	int 			native_vector_width;// CL_DEVICE_NATIVE_VECTOR_WIDTH_FLOAT
+	bool 			unified_memory;		// CL_DEVICE_HOST_UNIFIED_MEMORY
+	cl_command_queue_properties queue_properties;
+};
+
+bool query_device(cl_device_id device, DeviceInfo& info);
+
+// Every device of every platform, queried on the first call only
+const std::vector<DeviceInfo>& device_inventory();
+
+// Entry of the inventory, NULL when the device is unknown
+const DeviceInfo* find_device(cl_device_id device);
+const DeviceInfo* find_device(const std::string& identity);
+
+// Model inputs describing the device, named by device_feature_names()
+std::vector<double> device_features(const DeviceInfo& info);
+std::vector<std::string> device_feature_names();
+
 void clPrintDevInfo(cl_device_id device);
 int devicequery(void);
 
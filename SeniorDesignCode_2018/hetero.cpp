@@ -0,0 +1,251 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: hetero.cpp
+//	Function(s): HeteroSgemm::run(), HeteroSgemm::print_report(),
+//				 default_split_options()
+//
+//	Purpose: 	Runs one large multiply on every device at once. C is cut into row
+//				blocks: each device first gets a static share proportional to the
+//				GFLOP/s it reached in the previous run (equal shares the first time),
+//				then the remaining rows are handed out in chunks to whichever device
+//				finishes first. Each OpenCL device runs its tuned configuration from
+//				the tuning database and the host CPU runs cpu_sgemm(). Rows of a device
+//				whose launch fails are recomputed on the CPU. B is uploaded to each
+//				device once per run; a chunk only moves its rows of A and C.
+//
+/****************************************************************************************/
+
+#include "hetero.hpp"
+#include "roofline.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+SplitOptions default_split_options()
+{
+	SplitOptions options;
+	options.dynamic_fraction 	= 0.25;
+	options.chunk_rows 			= 0;
+	options.row_multiple 		= 16;
+	options.use_cpu 			= true;
+	return options;
+}
+
+static int round_to(int value, int step)
+{
+	return ((value + step / 2) / step) * step;
+}
+
+HeteroSgemm::HeteroSgemm(const SplitOptions& options)
+	: options(options)
+{
+	db.load();
+
+	std::vector<cl_device_id> ids = opencl_devices();
+	for (size_t i = 0; i < ids.size(); i++){
+		Session* session = new Session(ids[i]);
+		if (!session->ready()){
+			delete session;
+			continue;
+		}
+		SplitDevice device;
+		device.name = device_identity(ids[i]);
+		device.gflops = 0.0;
+		sessions.push_back(session);
+		devices.push_back(device);
+	}
+
+	// Every OpenCL device keeps one host thread busy feeding it
+	cpu_config = default_cpu_config(cpu_isa());
+	cpu_config.threads = std::max(1, available_cores() - (int) sessions.size());
+	if (options.use_cpu || sessions.empty()){
+		SplitDevice device;
+		device.name = std::string("Host CPU (") + cpu_isa_name(cpu_isa()) + ")";
+		device.gflops = 0.0;
+		sessions.push_back(NULL);
+		devices.push_back(device);
+	}
+
+	for (size_t d = 0; d < devices.size(); d++){
+		devices[d].rows = devices[d].chunks = 0;
+		devices[d].busy_ms = 0.0;
+		devices[d].failed = false;
+	}
+	configs.resize(sessions.size());
+}
+
+HeteroSgemm::~HeteroSgemm()
+{
+	for (size_t d = 0; d < sessions.size(); d++)
+		delete sessions[d];
+}
+
+// An OpenCL device only moves the A and C rows of the block; its B is resident
+bool HeteroSgemm::compute_rows(const int device, const ResidentB* resident, const int first,
+							   const int rows, const int N, const int K,
+							   const float* A, const int lda, const float* B, const int ldb,
+							   float* C, const int ldc)
+{
+	const float* A_rows = A + (size_t) first*lda;
+	float* C_rows = C + (size_t) first*ldc;
+	if (sessions[device])
+		return resident && run_sgemm_rows(*resident, rows, A_rows, lda, C_rows, ldc) >= 0;
+	return cpu_sgemm(cpu_config, cpu_isa(), rows, N, K, A_rows, lda, B, ldb, C_rows, ldc) == 0;
+}
+
+double HeteroSgemm::run(const int M, const int N, const int K,
+						const float* A, const int lda,
+						const float* B, const int ldb,
+						float* C,       const int ldc)
+{
+	const int n = size();
+	if (n == 0 || M <= 0 || N <= 0 || K <= 0)
+		return -1;
+
+	// The tuning database is not shared between threads, so look everything up first
+	for (int d = 0; d < n; d++){
+		if (sessions[d])
+			configs[d] = tuned_config(db, sessions[d]->device(), M, N, K);
+	}
+
+	// Weights from the last run; a device never measured gets the average
+	double known = 0.0;
+	int known_count = 0;
+	for (int d = 0; d < n; d++){
+		if (devices[d].gflops > 0){
+			known += devices[d].gflops;
+			known_count++;
+		}
+	}
+	std::vector<double> weight(n);
+	double total_weight = 0.0, max_weight = 0.0;
+	for (int d = 0; d < n; d++){
+		weight[d] = devices[d].gflops > 0 ? devices[d].gflops : (known_count ? known / known_count : 1.0);
+		total_weight += weight[d];
+		max_weight = std::max(max_weight, weight[d]);
+	}
+
+	// Static shares, then chunks on demand
+	const int step = std::max(1, options.row_multiple);
+	int static_rows = n == 1 ? M : std::min(M, round_to((int) ((1.0 - options.dynamic_fraction) * M), step));
+	int chunk = options.chunk_rows > 0 ? options.chunk_rows
+									   : std::max(step, round_to(M / (8 * n), step));
+
+	// Chunks shrink with the rate of the device, so a slow device never holds the last
+	// rows for longer than a fast one would; one too slow for even a single step of
+	// rows only does its static share
+	std::vector<int> device_chunk(n);
+	for (int d = 0; d < n; d++)
+		device_chunk[d] = options.chunk_rows > 0 ? chunk : round_to((int) (chunk * weight[d] / max_weight), step);
+
+	std::vector<int> share_begin(n + 1, 0);
+	double cumulative = 0.0;
+	for (int d = 0; d < n; d++){
+		cumulative += weight[d];
+		share_begin[d + 1] = d == n - 1 ? static_rows
+										: std::min(static_rows, round_to((int) (static_rows * cumulative / total_weight), step));
+		share_begin[d + 1] = std::max(share_begin[d + 1], share_begin[d]);
+	}
+
+	for (int d = 0; d < n; d++){
+		devices[d].rows = devices[d].chunks = 0;
+		devices[d].busy_ms = 0.0;
+		devices[d].failed = false;
+	}
+
+	std::atomic<int> next_row(static_rows);
+	std::mutex failed_lock;
+	std::vector<std::pair<int, int> > failed_rows;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+	for (int d = 0; d < n; d++){
+		workers.push_back(std::thread([&, d]() {
+			SplitDevice& device = devices[d];
+			int first = share_begin[d];
+			int rows = share_begin[d + 1] - share_begin[d];
+
+			// B goes to each OpenCL device once per run, counted in its busy time
+			std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+			std::unique_ptr<ResidentB> resident;
+			if (sessions[d])
+				resident.reset(new ResidentB(*sessions[d], configs[d], N, K, B, ldb));
+			device.busy_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+			while (true){
+				if (rows > 0){
+					t0 = std::chrono::steady_clock::now();
+					bool ok = compute_rows(d, resident.get(), first, rows, N, K, A, lda, B, ldb, C, ldc);
+					device.busy_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+					if (!ok){
+						// Leave the rest to the other devices and redo this block later
+						std::lock_guard<std::mutex> guard(failed_lock);
+						failed_rows.push_back(std::make_pair(first, rows));
+						device.failed = true;
+						return;
+					}
+					device.rows += rows;
+					device.chunks++;
+				}
+				if (device_chunk[d] <= 0)
+					return;
+				first = next_row.fetch_add(device_chunk[d]);
+				if (first >= M)
+					return;
+				rows = std::min(device_chunk[d], M - first);
+			}
+		}));
+	}
+	for (size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+
+	// Blocks of failed devices
+	for (size_t f = 0; f < failed_rows.size(); f++){
+		if (cpu_sgemm(cpu_config, cpu_isa(), failed_rows[f].second, N, K,
+					  A + (size_t) failed_rows[f].first*lda, lda, B, ldb,
+					  C + (size_t) failed_rows[f].first*ldc, ldc) != 0)
+			return -1;
+	}
+
+	double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// Rates for the next static split; a failed device gets no static share
+	for (int d = 0; d < n; d++){
+		if (devices[d].failed)
+			devices[d].gflops = 1e-6;
+		else if (devices[d].rows > 0 && devices[d].busy_ms > 0)
+			devices[d].gflops = sgemm_gflops(devices[d].rows, N, K, devices[d].busy_ms);
+	}
+	return wall;
+}
+
+void HeteroSgemm::print_report(const int M, const int N, const int K, const double wall_ms) const
+{
+	printf("\nSplit of %d x %d x %d over %d devices\n==========================\n", M, N, K, size());
+	for (int d = 0; d < size(); d++){
+		const SplitDevice& device = devices[d];
+		printf("	%s: %d rows (%.1f%%) in %d launches, busy %.3f ms, %.2f GFLOP/s%s\n",
+			   device.name.c_str(), device.rows, 100.0 * device.rows / M, device.chunks,
+			   device.busy_ms, device.failed ? 0.0 : device.gflops,
+			   device.failed ? ", failed (rows redone on the CPU)" : "");
+	}
+	printf("	Wall time: %.3f ms, %.2f GFLOP/s combined\n", wall_ms, sgemm_gflops(M, N, K, wall_ms));
+}
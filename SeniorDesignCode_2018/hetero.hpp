@@ -0,0 +1,90 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: hetero.hpp
+//	Purpose of File: Header File for hetero.cpp
+//
+/****************************************************************************************/
+
+#ifndef HETERO
+#define HETERO
+
+#include <string>
+#include <vector>
+
+#include "host.hpp"
+#include "cpu_sgemm.hpp"
+#include "tuning_db.hpp"
+
+// How the rows of C are shared out
+struct SplitOptions {
+	double 	dynamic_fraction;	// rows handed out on demand after the static shares
+	int 	chunk_rows;			// rows per on-demand chunk, 0 = picked from M
+	int 	row_multiple;		// shares are rounded to this many rows
+	bool 	use_cpu;			// run the native CPU backend next to the OpenCL devices
+};
+
+SplitOptions default_split_options();
+
+// What one device did in the last split run
+struct SplitDevice {
+	std::string name;
+	double 		gflops;		// measured rate, the weight of the next static share
+	int 		rows;		// rows of C computed
+	int 		chunks;		// separate launches
+	double 		busy_ms;	// wall time spent computing
+	bool 		failed;		// a launch failed; its rows were redone on the CPU
+};
+
+// One GEMM split by row blocks of C over every OpenCL device and the host CPU. Each
+// device gets a static share of the rows in proportion to its measured rate, and the
+// rest are pulled in chunks by whichever device is free, so a device that falls
+// behind takes fewer. The rates measured by each run weight the next one.
+class HeteroSgemm {
+public:
+	HeteroSgemm(const SplitOptions& options = default_split_options());
+	~HeteroSgemm();
+
+	int size() const 	{ return (int) devices.size(); }
+
+	// C = A * B for row-major A (M x K), B (K x N) and C (M x N); returns the wall time
+	// in milliseconds, -1 on failure
+	double run(const int M, const int N, const int K,
+			   const float* A, const int lda,
+			   const float* B, const int ldb,
+			   float* C,       const int ldc);
+
+	const std::vector<SplitDevice>& last_run() const 	{ return devices; }
+
+	// Rows, chunks, time and rate of every device in the last run
+	void print_report(const int M, const int N, const int K, const double wall_ms) const;
+
+private:
+	HeteroSgemm(const HeteroSgemm&);
+	HeteroSgemm& operator=(const HeteroSgemm&);
+
+	bool compute_rows(const int device, const ResidentB* resident, const int first,
+					  const int rows, const int N, const int K,
+					  const float* A, const int lda, const float* B, const int ldb,
+					  float* C, const int ldc);
+
+	SplitOptions 				options;
+	std::vector<Session*> 		sessions;	// NULL for the CPU backend
+	std::vector<KernelConfig> 	configs;	// tuned configuration of each OpenCL device
+	std::vector<SplitDevice> 	devices;
+	CpuConfig 					cpu_config;
+	TuningDB 					db;
+};
+
+#endif
@@ -13,14 +13,22 @@
 //	Last Update: May 1st, 2018
 //	
 //	File Name: host.cpp
-//	Function(s): host(), seedMatrix(), LoadOpenCLKernel()
+//	Function(s): host(), run_sgemm(), seedMatrix(), LoadOpenCLKernel(), make_config(),
+//				 build_options(), check_config(), config_fits(), config_features(),
+//				 config_feature_names(), enumerate_configs(), local_memory_bytes(),
+//				 padded_size(), launch_size(), set_sgemm_args(), copy_padded(),
+//				 layout_name(), parse_layout(), run_sgemm_rows(), ResidentB::ResidentB()
 //	
 //	Purpose: 	This file contains the necessary operations to properly execute the OpenCL
-//				kernel.
+//				kernel. The OpenCL device, context, queue, compiled programs and buffers
+//				are owned by the Session passed in, so they are reused across samples.
 //
 /****************************************************************************************/
 
 #include "host.hpp"
+#include "roofline.hpp"
+
+#include <algorithm>
 
 // Allocates a matrix with random float entries.
 void seedMatrix(float* data, int size)
@@ -85,12 +93,420 @@ long LoadOpenCLKernel(char const* path, char **buffer)
     return (long)filesize;
 }
 
+// Configuration for the global (0) or local memory block (1) kernels
+KernelConfig make_config(int local_mem, int block_size, int vector_width)
+{
+	KernelConfig config;
+	config.local_mem  = local_mem;
+	config.block_size = block_size;
+	config.tsm  = 0;
+	config.tsn  = 0;
+	config.tsk  = 0;
+	config.wptm = 0;
+	config.wptn = 0;
+	config.vector_width = vector_width;
+	config.edge_guard = 0;
+	return config;
+}
+
+// Configuration for the register-tiled kernel (2)
+KernelConfig make_config(int tsm, int tsn, int tsk, int wptm, int wptn, int vector_width)
+{
+	KernelConfig config = make_config(2, 1, vector_width);
+	config.tsm  = tsm;
+	config.tsn  = tsn;
+	config.tsk  = tsk;
+	config.wptm = wptm;
+	config.wptn = wptn;
+	return config;
+}
+
+const char* layout_name(const Transpose trans_a, const Transpose trans_b)
+{
+	static const char* names[] = {"NN", "NT", "TN", "TT"};
+	return names[2*(trans_a == TRANS) + (trans_b == TRANS)];
+}
+
+bool parse_layout(const std::string& name, Transpose& trans_a, Transpose& trans_b)
+{
+	if (name.size() != 2)
+		return false;
+	for (int i = 0; i < 2; i++){
+		char c = toupper(name[i]);
+		if (c != 'N' && c != 'T')
+			return false;
+		(i == 0 ? trans_a : trans_b) = c == 'T' ? TRANS : NO_TRANS;
+	}
+	return true;
+}
+
+// The -D options that select this configuration in sgemm.cl. Each transpose layout
+// and beta == 0 are built as separate programs; the defaults add nothing, so the
+// plain C = A * B kernel keeps its cached binaries.
+std::string build_options(const KernelConfig& config, const int batched,
+						  const Transpose trans_a, const Transpose trans_b, const int beta_zero)
+{
+	char options_buffer[300];
+	if (config.local_mem == 2){
+		sprintf(options_buffer, "-D LOCAL_MEM=2 -D TSM=%d -D TSN=%d -D TSK=%d -D WPTM=%d -D WPTN=%d -D VECTOR_WIDTH=%d -D EDGE_GUARD=%d",
+				config.tsm, config.tsn, config.tsk, config.wptm, config.wptn, config.vector_width, config.edge_guard);
+	}
+	else if (config.local_mem == 0){
+		sprintf(options_buffer, "-D LOCAL_MEM=0 -D BLOCK_SIZE=%d -D VECTOR_WIDTH=%d -D EDGE_GUARD=%d",
+				config.block_size, config.vector_width, config.edge_guard);
+	}
+	else {
+		sprintf(options_buffer, "-D LOCAL_MEM=%d -D BLOCK_SIZE=%d -D EDGE_GUARD=%d",
+				config.local_mem, config.block_size, config.edge_guard);
+	}
+	std::string options = options_buffer;
+	if (batched){
+		options += " -D BATCHED=1";
+	}
+	if (trans_a == TRANS){
+		options += " -D TRANS_A=1";
+	}
+	if (trans_b == TRANS){
+		options += " -D TRANS_B=1";
+	}
+	if (!beta_zero){
+		options += " -D BETA_ZERO=0";
+	}
+	return options;
+}
+
+// Reject configurations the kernel cannot run. Matrix sizes never make a configuration
+// invalid: edge tiles are either padded by the host or guarded in the kernel.
+bool check_config(const KernelConfig& config, const int display)
+{
+	int vw = config.vector_width;
+	if (config.local_mem != 1 && vw != 1 && vw != 2 && vw != 4 && vw != 8){
+		if (display) std::cout << "	Vector width must be 1, 2, 4 or 8!" << std::endl;
+		return false;
+	}
+
+	if (config.local_mem == 2){
+		if (config.tsm <= 0 || config.tsn <= 0 || config.tsk <= 0 ||
+			config.wptm <= 0 || config.wptn <= 0){
+			if (display) std::cout << "	Tile sizes must be positive!" << std::endl;
+			return false;
+		}
+		if (config.tsm % config.wptm || config.tsn % config.wptn){
+			if (display) std::cout << "	TSM/TSN must be multiples of WPTM/WPTN!" << std::endl;
+			return false;
+		}
+		int threads = (config.tsm/config.wptm) * (config.tsn/config.wptn);
+		// Every layout loads some tile along each of TSM, TSN and TSK
+		if (config.tsk % vw || config.tsn % vw || config.tsm % vw){
+			if (display) std::cout << "	TSM, TSN and TSK must be multiples of the vector width!" << std::endl;
+			return false;
+		}
+		if ((config.tsk*config.tsm) % (threads*vw) || (config.tsk*config.tsn) % (threads*vw)){
+			if (display) std::cout << "	Tiles cannot be loaded evenly by the work-group!" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	if (config.block_size <= 0){
+		if (display) std::cout << "	Block size must be positive!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Work-items in one work-group of this configuration
+int work_group_size(const KernelConfig& config)
+{
+	if (config.local_mem == 2){
+		return (config.tsm/config.wptm) * (config.tsn/config.wptn);
+	}
+	return config.block_size * config.block_size;
+}
+
+// Bytes of __local memory one work-group of this configuration declares in sgemm.cl
+int local_memory_bytes(const KernelConfig& config)
+{
+	if (config.local_mem == 2){
+		return sizeof(float) * config.tsk * (config.tsm + config.tsn);
+	}
+	if (config.local_mem == 1){
+		return sizeof(float) * 2 * config.block_size * config.block_size;
+	}
+	return 0;
+}
+
+// Reject configurations the device cannot launch: work-group size, work-group shape
+// and local memory
+bool config_fits(const KernelConfig& config, const DeviceInfo& device, const int display)
+{
+	size_t local_0 = config.local_mem == 2 ? config.tsn / config.wptn : config.block_size;
+	size_t local_1 = config.local_mem == 2 ? config.tsm / config.wptm : config.block_size;
+	
+	if (device.max_work_group > 0 && (size_t) work_group_size(config) > device.max_work_group){
+		if (display) std::cout << "	Work-group of " << work_group_size(config) << " is over the device limit of "
+							   << device.max_work_group << "!" << std::endl;
+		return false;
+	}
+	if ((device.max_work_item[0] > 0 && local_0 > device.max_work_item[0]) ||
+		(device.max_work_item[1] > 0 && local_1 > device.max_work_item[1])){
+		if (display) std::cout << "	Work-group shape is over the device limits!" << std::endl;
+		return false;
+	}
+	if (device.local_mem > 0 && (cl_ulong) local_memory_bytes(config) > device.local_mem){
+		if (display) std::cout << "	Tiles need " << local_memory_bytes(config) << " bytes of local memory, the device has "
+							   << device.local_mem << "!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+// Round value up to the next multiple of step
+static int round_up(int value, int step)
+{
+	return ((value + step - 1) / step) * step;
+}
+
+// Multiples of M, N and K that one work-group covers without edge checks
+static void tile_multiples(const KernelConfig& config, int& mult_m, int& mult_n, int& mult_k)
+{
+	if (config.local_mem == 2){
+		mult_m = config.tsm;
+		mult_n = config.tsn;
+		mult_k = config.tsk;
+	}
+	else if (config.local_mem == 1){
+		mult_m = config.block_size;
+		mult_n = config.block_size;
+		mult_k = config.block_size;
+	}
+	else {
+		mult_m = config.block_size;
+		mult_n = config.block_size * config.vector_width;
+		mult_k = 1;
+	}
+}
+
+// Sizes the kernel runs on: the shape itself for guarded kernels, otherwise
+// rounded up to whole tiles
+void padded_size(const KernelConfig& config, const int M, const int N, const int K,
+				 int& run_M, int& run_N, int& run_K)
+{
+	run_M = M;
+	run_N = N;
+	run_K = K;
+	if (!config.edge_guard){
+		int mult_m, mult_n, mult_k;
+		tile_multiples(config, mult_m, mult_n, mult_k);
+		run_M = round_up(M, mult_m);
+		run_N = round_up(N, mult_n);
+		run_K = round_up(K, mult_k);
+	}
+}
+
+// NDRange of one launch over a run_M x run_N result
+void launch_size(const KernelConfig& config, const int run_M, const int run_N,
+				 size_t* local, size_t* global)
+{
+	if (config.local_mem == 2){
+		// Each work-item computes WPTM x WPTN outputs; dimension 0 runs along N
+		local[0] 	= config.tsn / config.wptn;
+		local[1] 	= config.tsm / config.wptm;
+		global[0]	= round_up(run_N, config.tsn) / config.wptn;
+		global[1] 	= round_up(run_M, config.tsm) / config.wptm;
+	}
+	else if (config.local_mem == 0){
+		// Each work-item computes VECTOR_WIDTH neighbouring columns of one row
+		int columns = (run_N + config.vector_width - 1) / config.vector_width;
+		local[0] 	= config.block_size;
+		local[1] 	= config.block_size;
+		global[0]	= round_up(run_M, config.block_size);
+		global[1] 	= round_up(columns, config.block_size);
+	}
+	else {
+		// Dimension 0 runs along the columns of C
+		local[0] 	= config.block_size;
+		local[1] 	= config.block_size;
+		global[0]	= round_up(run_N, config.block_size);
+		global[1] 	= round_up(run_M, config.block_size);
+	}
+}
+
+// Arguments of the sgemm kernel, in the order sgemm.cl declares them
+cl_int set_sgemm_args(cl_kernel kernel, cl_mem d_C, cl_mem d_A, cl_mem d_B,
+					  int run_M, int run_N, int run_K, int lda, int ldb, int ldc,
+					  float alpha, float beta)
+{
+	cl_int err;
+	err  = clSetKernelArg(kernel, 0, sizeof(cl_mem), (void *)&d_C);
+	err |= clSetKernelArg(kernel, 1, sizeof(cl_mem), (void *)&d_A);
+	err |= clSetKernelArg(kernel, 2, sizeof(cl_mem), (void *)&d_B);
+	err |= clSetKernelArg(kernel, 3, sizeof(int)   , (void *)&run_M);
+	err |= clSetKernelArg(kernel, 4, sizeof(int)   , (void *)&run_N);
+	err |= clSetKernelArg(kernel, 5, sizeof(int)   , (void *)&run_K);
+	err |= clSetKernelArg(kernel, 6, sizeof(int)   , (void *)&lda);
+	err |= clSetKernelArg(kernel, 7, sizeof(int)   , (void *)&ldb);
+	err |= clSetKernelArg(kernel, 8, sizeof(int)   , (void *)&ldc);
+	err |= clSetKernelArg(kernel, 9, sizeof(float) , (void *)&alpha);
+	err |= clSetKernelArg(kernel, 10, sizeof(float), (void *)&beta);
+	return err;
+}
+
+// Copy a rows x cols matrix with leading dimension ld into a zero-filled
+// padded_rows x padded_cols matrix
+void copy_padded(const float* src, int rows, int cols, int ld,
+						float* dst, int padded_rows, int padded_cols)
+{
+	memset(dst, 0, sizeof(float) * padded_rows * padded_cols);
+	for (int i = 0; i < rows; i++){
+		memcpy(dst + i*padded_cols, src + i*ld, sizeof(float) * cols);
+	}
+}
+
+// Display the inputs of one sample
+void print_inputs(const int M, const int N, const int K, const KernelConfig& config)
+{
+	printf("	Inputs:  [%d, %d, %d, %d, %d, %d, %d, %d, %d, %d, %d, %d]\n", M, N, K,
+		   config.local_mem, config.block_size, config.tsm, config.tsn, config.tsk,
+		   config.wptm, config.wptn, config.vector_width, config.edge_guard);
+}
+
+// Names of the model inputs, in the order of config_features()
+std::vector<std::string> config_feature_names()
+{
+	static const char* shape_columns[] = {"M", "N", "K", "Batch", "Trans_A", "Trans_B",
+										  "Local_Mem", "Block_Size", "TSM", "TSN", "TSK",
+										  "WPTM", "WPTN", "Vector_Width", "Edge_Guard"};
+	std::vector<std::string> names(shape_columns, shape_columns + 15);
+	std::vector<std::string> device_columns = device_feature_names();
+	names.insert(names.end(), device_columns.begin(), device_columns.end());
+	return names;
+}
+
+// Column names of the sample CSV files
+void write_csv_header(std::ofstream& csv)
+{
+	csv << "Time";
+	std::vector<std::string> columns = config_feature_names();
+	for (size_t i = 0; i < columns.size(); i++){
+		csv << "," << columns[i];
+	}
+	csv << ",Build_ms,Host_ms,Upload_ms,Download_ms,End_To_End_ms";
+	csv << "\n";
+}
+
+// One sample: the measured time followed by every input, the device, then the phases
+// of the run (-1 where they were not measured)
+void write_csv_row(std::ofstream& csv, const double time,
+				   const int M, const int N, const int K, const KernelConfig& config,
+				   const DeviceInfo* device, const int batch,
+				   const Transpose trans_a, const Transpose trans_b,
+				   const PhaseTimes* phases)
+{
+	csv << time << ",";
+	csv << M << ",";
+	csv << N << ",";
+	csv << K << ",";
+	csv << batch << ",";
+	csv << trans_a << ",";
+	csv << trans_b << ",";
+	csv << config.local_mem << ",";
+	csv << config.block_size << ",";
+	csv << config.tsm << ",";
+	csv << config.tsn << ",";
+	csv << config.tsk << ",";
+	csv << config.wptm << ",";
+	csv << config.wptn << ",";
+	csv << config.vector_width << ",";
+	csv << config.edge_guard;
+	std::vector<double> device_columns = config_features(M, N, K, config, device, batch, trans_a, trans_b);
+	for (size_t i = 15; i < device_columns.size(); i++){
+		csv << "," << device_columns[i];
+	}
+	if (phases){
+		csv << "," << phases->build << "," << phases->host << "," << phases->upload;
+		csv << "," << phases->download << "," << end_to_end(*phases);
+	}
+	else {
+		csv << ",-1,-1,-1,-1,-1";
+	}
+	csv << "\n";
+}
+
+// Model inputs of one sample, in the column order of write_csv_row (without Time).
+// The batch count and the transposes are part of the shape; the device columns are
+// zero when the device is unknown.
+std::vector<double> config_features(const int M, const int N, const int K, const KernelConfig& config,
+									const DeviceInfo* device, const int batch,
+									const Transpose trans_a, const Transpose trans_b)
+{
+	std::vector<double> x(15);
+	x[0]  = M;
+	x[1]  = N;
+	x[2]  = K;
+	x[3]  = batch;
+	x[4]  = trans_a;
+	x[5]  = trans_b;
+	x[6]  = config.local_mem;
+	x[7]  = config.block_size;
+	x[8]  = config.tsm;
+	x[9]  = config.tsn;
+	x[10] = config.tsk;
+	x[11] = config.wptm;
+	x[12] = config.wptn;
+	x[13] = config.vector_width;
+	x[14] = config.edge_guard;
+	
+	std::vector<double> d = device ? device_features(*device)
+								   : std::vector<double>(device_feature_names().size(), 0.0);
+	x.insert(x.end(), d.begin(), d.end());
+	return x;
+}
+
+// Every valid configuration of the parameter sets generate_samples() draws from,
+// without the ones the device cannot launch when it is given
+void enumerate_configs(std::vector<KernelConfig>& configs, const DeviceInfo* device)
+{
+	static const int block_sizes[]   = {1,2,4,8,16};
+	static const int tile_sizes[]    = {16,32,64,128};
+	static const int tile_depths[]   = {8,16,32};
+	static const int work_per_item[] = {1,2,4,8};
+	static const int vector_widths[] = {1,2,4,8};
+
+	configs.clear();
+	for (int edge = 0; edge <= 1; edge++){
+		for (int v = 0; v < 4; v++){
+			KernelConfig config = make_config(0, 1, vector_widths[v]);
+			config.edge_guard = edge;
+			configs.push_back(config);
+		}
+		for (int b = 0; b < 5; b++){
+			KernelConfig config = make_config(1, block_sizes[b]);
+			config.edge_guard = edge;
+			if (!device || config_fits(config, *device))
+				configs.push_back(config);
+		}
+		for (int m = 0; m < 4; m++)
+		for (int n = 0; n < 4; n++)
+		for (int k = 0; k < 3; k++)
+		for (int wm = 0; wm < 4; wm++)
+		for (int wn = 0; wn < 4; wn++)
+		for (int v = 0; v < 4; v++){
+			KernelConfig config = make_config(tile_sizes[m], tile_sizes[n], tile_depths[k],
+											  work_per_item[wm], work_per_item[wn], vector_widths[v]);
+			config.edge_guard = edge;
+			if (check_config(config, 0) && (!device || config_fits(config, *device)))
+				configs.push_back(config);
+		}
+	}
+}
+
 //Function to display the matrices
-void printMatrix(float* buffer, int dimension){
+void printMatrix(float* buffer, int rows, int columns){
 	
-	for(int i = 0; i < dimension; i++){
-		for(int j = 0; j < dimension; j++){			
-			printf("%03.2f\t ", buffer[i*dimension+j]);
+	for(int i = 0; i < rows; i++){
+		for(int j = 0; j < columns; j++){			
+			printf("%03.2f\t ", buffer[i*columns+j]);
 		}
 		printf("\n");
 	}
@@ -99,318 +515,496 @@ void printMatrix(float* buffer, int dimension){
 }
 
 
-double host(const int matrix_dim,  const int local_mem, 
-			const int block_size,  const int display){
-			
-	if(block_size > matrix_dim){
-		std::cout << "	Block size exceeds matrix dimension size!" << std::endl;
-		return -1;
+// Fill a device buffer with a rows x cols host matrix, zero-padded to run_rows x run_cols
+// when those are larger. Shared-memory devices get it written through a mapping;
+// otherwise padding is staged in pinned memory and the matrix copied from there. The
+// event of every command is appended to events.
+static bool upload_matrix(cl_command_queue queue, BufferPool& pool, cl_mem buffer,
+						  const float* src, int rows, int cols, int ld,
+						  int run_rows, int run_cols, size_t bytes,
+						  std::vector<cl_event>& events)
+{
+	cl_int err;
+	cl_event event = NULL;
+	bool padded = run_rows != rows || run_cols != cols;
+	
+	if (pool.zero_copy()){
+		float* dst = (float*) clEnqueueMapBuffer(queue, buffer, CL_TRUE, CL_MAP_WRITE, 0, bytes, 0, NULL, &event, &err);
+		if (err != CL_SUCCESS || !dst){
+			std::cerr << "	Error. Failed to map device memory!" << err << std::endl;
+			return false;
+		}
+		events.push_back(event);
+		if (padded)
+			copy_padded(src, rows, cols, ld, dst, run_rows, run_cols);
+		else
+			memcpy(dst, src, bytes);
+		if (clEnqueueUnmapMemObject(queue, buffer, dst, 0, NULL, &event) != CL_SUCCESS)
+			return false;
+		events.push_back(event);
+		return true;
 	}
-			
 	
-	std::string kernel_name;
-	const char * nameKernel = kernel_name.c_str();
-	std::string program_name;
-	const char * nameProgram = program_name.c_str();
+	if (padded){
+		PinnedHost staging(pool, bytes);
+		if (!staging.get())
+			return false;
+		copy_padded(src, rows, cols, ld, staging.get(), run_rows, run_cols);
+		err = clEnqueueWriteBuffer(queue, buffer, CL_TRUE, 0, bytes, staging.get(), 0, NULL, &event);
+	}
+	else {
+		err = clEnqueueWriteBuffer(queue, buffer, CL_TRUE, 0, bytes, src, 0, NULL, &event);
+	}
+	if (err != CL_SUCCESS){
+		std::cerr << "	Error. Failed to write the input arrays!" << err << std::endl;
+		return false;
+	}
+	events.push_back(event);
+	return true;
+}
+
+// Copy the rows x cols result out of a device buffer with leading dimension run_ld,
+// appending the event of every command to events. A padded buffer is copied row by row
+// even when run_ld happens to equal ld, since the padding columns are not the caller's.
+static bool download_matrix(cl_command_queue queue, BufferPool& pool, cl_mem buffer,
+							float* dst, int rows, int cols, int ld, int run_ld, bool padded,
+							size_t bytes, std::vector<cl_event>& events)
+{
+	cl_int err;
+	cl_event event = NULL;
 	
-	kernel_name = "sgemm.cl";
-	program_name = "sgemm";	
+	if (pool.zero_copy()){
+		float* src = (float*) clEnqueueMapBuffer(queue, buffer, CL_TRUE, CL_MAP_READ, 0, bytes, 0, NULL, &event, &err);
+		if (err != CL_SUCCESS || !src)
+			return false;
+		events.push_back(event);
+		if (padded){
+			for (int i = 0; i < rows; i++)
+				memcpy(dst + (size_t) i*ld, src + (size_t) i*run_ld, sizeof(float) * cols);
+		}
+		else {
+			memcpy(dst, src, sizeof(float) * ((size_t)(rows - 1) * ld + cols));
+		}
+		if (clEnqueueUnmapMemObject(queue, buffer, src, 0, NULL, &event) != CL_SUCCESS)
+			return false;
+		events.push_back(event);
+		return true;
+	}
+	
+	if (padded){
+		PinnedHost staging(pool, bytes);
+		if (!staging.get() ||
+			clEnqueueReadBuffer(queue, buffer, CL_TRUE, 0, bytes, staging.get(), 0, NULL, &event) != CL_SUCCESS)
+			return false;
+		events.push_back(event);
+		for (int i = 0; i < rows; i++)
+			memcpy(dst + (size_t) i*ld, staging.get() + (size_t) i*run_ld, sizeof(float) * cols);
+		return true;
+	}
+	if (clEnqueueReadBuffer(queue, buffer, CL_TRUE, 0, sizeof(float) * ((size_t)(rows - 1) * ld + cols),
+							dst, 0, NULL, &event) != CL_SUCCESS)
+		return false;
+	events.push_back(event);
+	return true;
+}
+
+
+// Run C = A * B on the device for row-major A (M x K), B (K x N) and C (M x N) with
+// leading dimensions lda, ldb and ldc. Returns the kernel time in milliseconds: one
+// launch without bench, otherwise the median of the repetitions bench asks for. The
+// timing lines are printed unless display is 0.
+double run_sgemm(Session& session,   const KernelConfig& config,
+				 const int M, const int N, const int K,
+				 const float* A, const int lda,
+				 const float* B, const int ldb,
+				 float* C,       const int ldc,
+				 const BenchmarkOptions* bench, BenchmarkStats* stats,
+				 const int display){
+	return run_sgemm(session, config, NO_TRANS, NO_TRANS, M, N, K, 1.0f, A, lda, B, ldb,
+					 0.0f, C, ldc, bench, stats, display);
+}
+
+// C = alpha * op(A) * op(B) + beta * C, where op(A) is M x K and op(B) is K x N. A
+// transposed A is stored K x M with leading dimension lda (likewise B, stored N x K).
+// With beta == 0 C is never read, so it may hold anything on entry.
+double run_sgemm(Session& session,   const KernelConfig& config,
+				 const Transpose trans_a, const Transpose trans_b,
+				 const int M, const int N, const int K, const float alpha,
+				 const float* A, const int lda,
+				 const float* B, const int ldb, const float beta,
+				 float* C,       const int ldc,
+				 const BenchmarkOptions* bench, BenchmarkStats* stats,
+				 const int display){
 
-	int dim = matrix_dim;
+	if(!check_config(config)){
+		return -1;
+	}
 	
-	std::cout << " Size of dim: " 				<< size_t(matrix_dim) 	<< std::endl;
-	std::cout << " Size of local mem: " 		<< size_t(local_mem) 	<< std::endl;
-	std::cout << " Size of block sub matrix: " 	<< size_t(block_size) 	<< std::endl;
+	if(!session.ready()){
+		std::cerr << "	Error. OpenCL session is not available!" << std::endl;
+		return -1;
+	}
 	
+	// Skip launches the device would reject instead of building them first
+	if(session.info() && !config_fits(config, *session.info(), 1)){
+		return -1;
+	}
+
+	const char * nameProgram = "sgemm";
 
 	//Set OpenCL Variables
 	cl_int				err;                            
-   	cl_device_id 		device_id;            
-   	cl_context 			context;                 
-   	cl_command_queue 	queue;          
-   	cl_program 			program;                 
    	cl_kernel 			kernel;                   
-   	
-   	// OpenCL device memory for matrices
-   	cl_mem d_A;
-   	cl_mem d_B;
-   	cl_mem d_C;
-   	
-   	//Allocate host memory for matrices A and B
-   	unsigned int size_A = dim * dim;
-   	unsigned int mem_size_A = sizeof(float) * size_A;
-   	float* h_A = (float*) malloc(mem_size_A);
-   	float* hostA_copy = h_A;
- 
-   	unsigned int size_B = dim * dim;
-   	unsigned int mem_size_B = sizeof(float) * size_B;
-   	float* h_B = (float*) malloc(mem_size_B);
-   	float* hostB_copy = h_B;
+   	cl_command_queue queue = session.queue();
+   	BufferPool& pool = session.pool();
 
-   	//Initialize host memory
-   	seedMatrix(hostA_copy, size_A);
-   	seedMatrix(hostB_copy, size_B);
- 
-   	//Allocate host memory for the result C
-   	unsigned int size_C = dim * dim;
-   	unsigned int mem_size_C = sizeof(float) * size_C;
-   	float* h_C = (float*) malloc(mem_size_C);
-   	float* hostC_copy = h_C;
-   	
-   	//Allocate host memory for test function
-   	unsigned int size_test = dim * dim;
-   	unsigned int mem_size_test = sizeof(float) * size_test;
-   	float* h_test = (float*) malloc(mem_size_test);
-   	float* h_copy = h_test;
-   	
-   	//OpenCL Platforms
-   	cl_uint dev_cnt = 0;
-   	clGetPlatformIDs(0, 0, &dev_cnt);
-	
-   	cl_platform_id platform_ids[100];
-   	clGetPlatformIDs(dev_cnt, platform_ids, NULL);
-   	
-   	//Select OpenCL Device
-   	err = clGetDeviceIDs(platform_ids[0], CL_DEVICE_TYPE_GPU, 1, &device_id, NULL);
-   	if (err != CL_SUCCESS)
+   	// Fetch the compiled kernel for these build options (built once per session)
+   	PhaseTimes phases = no_phases();
+   	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   	int beta_zero = beta == 0.0f;
+   	kernel = session.get_kernel(build_options(config, 0, trans_a, trans_b, beta_zero), nameProgram);
+   	if (!kernel)
    	{
-    	std::cerr << "	Error: Failed to create a device group!\n";
-    	return -1;
-   	}
-   	
-   	// Create a compute context 
-   	context = clCreateContext(0, 1, &device_id, NULL, NULL, &err);
-   	if (!context)
-   	{
-       	std::cerr << "	Error. Failed to create a compute context!\n";
-       	return -1;
-   	}
-   	
-   	// Create a command queue
-   	queue = clCreateCommandQueue(context, device_id, CL_QUEUE_PROFILING_ENABLE, &err);
-   	if (!queue)
-   	{
-       	std::cerr << "	Error. Failed to create a command queue!\n";
-       	return -1;
-   	}
-   	
-   	// Create the compute program from the source file
-   	char *KernelSource;
-   	long lFileSize;
-
-   	lFileSize = LoadOpenCLKernel(nameKernel, &KernelSource);
-   	if( lFileSize < 0L ) {
-       	perror("	File read failed");
        	return -1;
    	}
+   	phases.build = elapsed_ms(start);
+   	start = std::chrono::steady_clock::now();
    	
-   	program = clCreateProgramWithSource(context, 1, (const char **) & KernelSource, NULL, &err);
-   	if (!program)
-   	{
-       	std::cerr << "	Error. Failed to create compute program!\n";
-       	return -1;
-   	}
+   	// Sizes the kernel runs on. Guarded kernels take the matrices as they are;
+   	// otherwise they are zero-padded to whole tiles on the host first.
+   	int run_M, run_N, run_K;
+   	padded_size(config, M, N, K, run_M, run_N, run_K);
    	
-   	// Build the program executable with options
+   	// Stored shapes of A and B, which are the transposes of op(A) and op(B) when
+   	// those are transposed
+   	int rows_A = trans_a ? K : M, cols_A = trans_a ? M : K;
+   	int rows_B = trans_b ? N : K, cols_B = trans_b ? K : N;
+   	int run_rows_A = trans_a ? run_K : run_M, run_cols_A = trans_a ? run_M : run_K;
+   	int run_rows_B = trans_b ? run_N : run_K, run_cols_B = trans_b ? run_K : run_N;
    	
-   	char options_buffer[300];
-   	sprintf(options_buffer, "-D LOCAL_MEM=%d -D BLOCK_SIZE=%d", local_mem, block_size);
+   	bool pad_A = run_M != M || run_K != K;
+   	bool pad_B = run_K != K || run_N != N;
+   	bool pad_C = run_M != M || run_N != N;
+   	int run_lda = pad_A ? run_cols_A : lda;
+   	int run_ldb = pad_B ? run_cols_B : ldb;
+   	int run_ldc = pad_C ? run_N : ldc;
    	
-   	err = clBuildProgram(program, 0, NULL, options_buffer, NULL, NULL);
-   	if (err != CL_SUCCESS)
-   	{
-       	size_t len;
-       	char buffer[2048];
-       	std::cerr << "	Error. Failed to build program executable!\n";
-       	clGetProgramBuildInfo(program, device_id, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
-       	std::cout << buffer;
-       	free(h_A);
-   		free(h_B);
-   		free(h_C);
-       	return -1;
-   	}
+   	// Bytes spanned by each matrix; rows past the last one are not touched
+   	size_t mem_size_A = sizeof(float) * ((size_t)(run_rows_A - 1) * run_lda + run_cols_A);
+   	size_t mem_size_B = sizeof(float) * ((size_t)(run_rows_B - 1) * run_ldb + run_cols_B);
+   	size_t mem_size_C = sizeof(float) * ((size_t)(run_M - 1) * run_ldc + run_N);
    	
-   	// Create the compute kernel in the program we wish to run
-   	//
-   	kernel = clCreateKernel(program, nameProgram, &err);
-   	if (!kernel || err != CL_SUCCESS)
+   	// OpenCL device memory for matrices, from the session pool. On a device sharing
+   	// host memory the buffers are allocated by the runtime so mapping them is free.
+   	cl_mem_flags flags = CL_MEM_READ_WRITE | (pool.zero_copy() ? CL_MEM_ALLOC_HOST_PTR : 0);
+   	PooledBuffer d_A(pool, mem_size_A, flags);
+   	PooledBuffer d_B(pool, mem_size_B, flags);
+   	PooledBuffer d_C(pool, mem_size_C, flags);
+   	if (!d_A.get() || !d_B.get() || !d_C.get())
    	{
-       	std::cerr << "	Error. Failed to create compute kernel!\n";
        	return -1;
    	}
    	
-   	// Create the input and output arrays in device memory for our calculation
-   	d_C = clCreateBuffer(context, CL_MEM_READ_WRITE, mem_size_A, NULL, &err);
-   	d_A = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, mem_size_A, hostA_copy, &err);
-   	d_B = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, mem_size_B, hostB_copy, &err);
-
-   	if (!d_A || !d_B || !d_C)
+   	// C starts from the host copy when the kernel reads it (beta != 0) or ldc leaves
+   	// gaps the kernel never writes
+   	std::vector<cl_event> transfers;
+   	if (!upload_matrix(queue, pool, d_A.get(), A, rows_A, cols_A, lda, run_rows_A, run_cols_A, mem_size_A, transfers) ||
+   		!upload_matrix(queue, pool, d_B.get(), B, rows_B, cols_B, ldb, run_rows_B, run_cols_B, mem_size_B, transfers) ||
+   		((!beta_zero || run_ldc != run_N) &&
+   		 !upload_matrix(queue, pool, d_C.get(), C, M, N, ldc, run_M, run_N, mem_size_C, transfers)))
    	{
-       	std::cerr << "	Error. Failed to allocate device memory!\n";
-       	return -1;
+   		drain_events(transfers);
+   		return -1;
    	}
-   	
-   	std::cout << "	Running matrix multiplication for matrices A (" << dim 
-   			  << "x" << dim << ")  and B (" << dim << "x" << dim << ") ...\n";
+   	phases.upload = drain_events(transfers);
    			  
    	//Launch OpenCL kernel
    	size_t localWorkSize[2];	
-   	size_t globalWorkSize[2]; 	//The global_work_size is essentially the size of your problem
-   								//If the global_work_size is not the size of your problem it causes weird computations
+   	size_t globalWorkSize[2]; 	//The global work size covers every tile of C; work-items
+   								//past the edge are masked off by EDGE_GUARD
 
 	//Set Kernel Arguments
-	err  = clSetKernelArg(kernel, 0, sizeof(cl_mem), (void *)&d_C);
-   	err |= clSetKernelArg(kernel, 1, sizeof(cl_mem), (void *)&d_A);
-   	err |= clSetKernelArg(kernel, 2, sizeof(cl_mem), (void *)&d_B);
-   	err |= clSetKernelArg(kernel, 3, sizeof(int)   , (void *)&dim);
+	err = set_sgemm_args(kernel, d_C.get(), d_A.get(), d_B.get(), run_M, run_N, run_K, run_lda, run_ldb, run_ldc,
+						 alpha, beta);
 
+   	double time = -1;
+   	
+   	//Local and Global Work Size
+   	launch_size(config, run_M, run_N, localWorkSize, globalWorkSize);
+   	
+   	// Untimed warm-up launches, then timed launches until the median is stable
+   	BenchmarkOptions options = bench ? *bench : single_run_options();
+   	BenchmarkStats result;
+   	
+   	// Host work before the launches is what the wall clock saw beyond the uploads
+   	phases.host = std::max(0.0, elapsed_ms(start) - phases.upload);
+   	
    	if (err != CL_SUCCESS)
    	{
-       std::cerr << "	Error. Failed to set kernel arguments!" << err << std::endl;
-       return -1;
+       	std::cerr << "	Error. Failed to set kernel arguments!" << err << std::endl;
+   	}
+   	else
+   	{
+   		err = benchmark_kernel(queue, kernel, 2, globalWorkSize, localWorkSize, options, result);
    	}
    	
-   	cl_event event;
-   	double time;
-   	
-   	//Local and Global Work Size
-   	localWorkSize[0] 	= block_size;
-   	localWorkSize[1] 	= block_size;
-   	globalWorkSize[0]	= dim;
-   	globalWorkSize[1] 	= dim;
-   	
-   	err = clEnqueueNDRangeKernel(queue, kernel, 2, NULL, globalWorkSize, localWorkSize, 0, NULL, &event);
-
-    if (err != CL_SUCCESS)
+    //Retrieve result from device, dropping the padding
+    if (err == CL_SUCCESS)
     {
-    	std::cerr << "	Error. Failed to execute kernel!" << err << std::endl;
-       	free(h_A);
-   		free(h_B);
-   		free(h_C);
-    	return -1;
+    	start = std::chrono::steady_clock::now();
+    	bool downloaded = download_matrix(queue, pool, d_C.get(), C, M, N, ldc, run_ldc, pad_C,
+    											  mem_size_C, transfers);
+    	phases.download = drain_events(transfers);
+    	phases.host += std::max(0.0, elapsed_ms(start) - phases.download);
+    	phases.kernel = result.median;
+    	result.phases = phases;
+    	if (!downloaded)
+    	{
+       		std::cerr << "	Error. Failed to read output array!" << std::endl;
+    	}
+    	else
+    	{
+    		time = result.median;
+    		if (display){
+    			std::cout << "	Execution Time (msec): " << time << std::endl;
+    			printf("	Throughput: %.2f GFLOP/s, %.2f GB/s effective\n",
+    				   sgemm_gflops(M, N, K, time), sgemm_bandwidth(M, N, K, time));
+    		}
+    		if (display && result.reps > 1){
+    			print_stats(result);
+    		}
+    		if (display){
+    			print_phases(result.phases);
+    		}
+    		if (stats){
+    			*stats = result;
+    		}
+    	}
     }
-    
-    err = clFinish(queue);
    
-    if (err != CL_SUCCESS)
-    {
-   	 	std::cerr << "	Error. Waiting for kernel!" << err << std::endl;
-   	   	free(h_A);
-   		free(h_B);
-   		free(h_C);
-   	 	return -1;
-    }
-    
-    // The unsigned 64-bit values returned can be used to measure the time in nano-seconds consumed by OpenCL commands.
-    cl_ulong start_time, end_time;
-    err = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &start_time, NULL);
-    err = clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &end_time, NULL);
-      
-    // time in milliseconds
-    std::cout << "	Execution Time (msec): " << (double)(end_time - start_time)/1000000.0 << std::endl;
-    time = (double)(end_time - start_time)/1000000.0;
-    
-    if (err != CL_SUCCESS)
-    {
-   	   if 		(err == CL_PROFILING_INFO_NOT_AVAILABLE) {
-   	   			std::cerr << "	Error. Cl profiling info not available! " << std::endl; }
-   	   else if 	(err == CL_INVALID_VALUE) {
-   	   			std::cerr << "	Error. Cl invalid value! " << std::endl; }
-   	   else if 	(err == CL_INVALID_EVENT) {
-   	   			std::cerr << "	Error. Cl invalid event! " << std::endl; }
-   	   else {
-   	   			std::cerr << "	Error. Timing Error!" << err <<std::endl; }
-   	   return -1;
-    }
-    
-    //Retrieve result from device
-    err = clEnqueueReadBuffer(queue, d_C, CL_TRUE, 0, mem_size_C, hostC_copy, 0, NULL, NULL);
+   	// The buffers go back to the pool on every path
+   	return time;
+}
 
-    if (err != CL_SUCCESS)
-    {
-       std::cerr << "	Error. Failed to read output array!" << err << std::endl;
-       	free(h_A);
-   		free(h_B);
-   		free(h_C);
-       return -1;
-    }
-   
-    clWaitForEvents(1, &event);
-    clReleaseEvent(event);
+
+ResidentB::ResidentB(Session& session, const KernelConfig& config, const int N, const int K,
+					 const float* B, const int ldb)
+	: session(session), config(config), N(N), K(K), buffer(NULL), uploaded(false)
+{
+	if (!check_config(config, 0) || !session.ready())
+		return;
+
+	int run_M;
+	padded_size(config, 1, N, K, run_M, run_N, run_K);
+	bool padded = run_N != N || run_K != K;
+	run_ldb = padded ? run_N : ldb;
+	size_t bytes = sizeof(float) * ((size_t)(run_K - 1) * run_ldb + run_N);
+
+	BufferPool& pool = session.pool();
+	buffer = pool.acquire(bytes, CL_MEM_READ_WRITE | (pool.zero_copy() ? CL_MEM_ALLOC_HOST_PTR : 0));
+	if (!buffer)
+		return;
+
+	std::vector<cl_event> transfers;
+	uploaded = upload_matrix(session.queue(), pool, buffer, B, K, N, ldb, run_K, run_N, bytes,
+							 transfers);
+	drain_events(transfers);
+}
+
+ResidentB::~ResidentB()
+{
+	if (buffer)
+		session.pool().release(buffer);
+}
+
+double run_sgemm_rows(const ResidentB& B, const int rows,
+					  const float* A, const int lda, float* C, const int ldc)
+{
+	if (!B.ready() || rows <= 0)
+		return -1;
+
+	Session& session = B.session;
+	const KernelConfig& config = B.config;
+	cl_kernel kernel = session.get_kernel(build_options(config), "sgemm");
+	if (!kernel)
+		return -1;
+
+	// Only the rows are padded here; B was padded to the same run_N and run_K
+	int run_M, run_N, run_K;
+	padded_size(config, rows, B.N, B.K, run_M, run_N, run_K);
+	bool pad_A = run_M != rows || run_K != B.K;
+	bool pad_C = run_M != rows || run_N != B.N;
+	int run_lda = pad_A ? run_K : lda;
+	int run_ldc = pad_C ? run_N : ldc;
+	size_t mem_size_A = sizeof(float) * ((size_t)(run_M - 1) * run_lda + run_K);
+	size_t mem_size_C = sizeof(float) * ((size_t)(run_M - 1) * run_ldc + run_N);
+
+	BufferPool& pool = session.pool();
+	cl_command_queue queue = session.queue();
+	cl_mem_flags flags = CL_MEM_READ_WRITE | (pool.zero_copy() ? CL_MEM_ALLOC_HOST_PTR : 0);
+	PooledBuffer d_A(pool, mem_size_A, flags);
+	PooledBuffer d_C(pool, mem_size_C, flags);
+	if (!d_A.get() || !d_C.get())
+		return -1;
+
+	// C is only read back, but gaps of a wider ldc must survive the readback
+	std::vector<cl_event> transfers;
+	bool ok = upload_matrix(queue, pool, d_A.get(), A, rows, B.K, lda, run_M, run_K, mem_size_A,
+							transfers) &&
+			  (run_ldc == run_N ||
+			   upload_matrix(queue, pool, d_C.get(), C, rows, B.N, ldc, run_M, run_N, mem_size_C,
+							 transfers));
+	drain_events(transfers);
+	if (!ok)
+		return -1;
+
+	size_t local[2], global[2];
+	launch_size(config, run_M, run_N, local, global);
+	BenchmarkStats result;
+	cl_int err = set_sgemm_args(kernel, d_C.get(), d_A.get(), B.buffer, run_M, run_N, run_K,
+								run_lda, B.run_ldb, run_ldc);
+	if (err == CL_SUCCESS)
+		err = benchmark_kernel(queue, kernel, 2, global, local, single_run_options(), result);
+	if (err != CL_SUCCESS)
+		return -1;
+
+	ok = download_matrix(queue, pool, d_C.get(), C, rows, B.N, ldc, run_ldc, pad_C, mem_size_C, transfers);
+	drain_events(transfers);
+	return ok ? result.median : -1;
+}
+
+
+// Dense cols x rows transpose of a rows x cols matrix, for checking transposed layouts
+static std::vector<float> transposed(const float* src, int rows, int cols)
+{
+	std::vector<float> dst((size_t) rows * cols);
+	for (int i = 0; i < rows; i++)
+		for (int j = 0; j < cols; j++)
+			dst[(size_t) j*rows + i] = src[(size_t) i*cols + j];
+	return dst;
+}
+
+double host(Session& session,       const int M, const int N, const int K,
+			const KernelConfig& config, const int display,
+			const BenchmarkOptions* bench, BenchmarkStats* stats,
+			const VerifyOptions* verify,
+			const Transpose trans_a, const Transpose trans_b){
+	
+	// Every early return leaves stats as the summary of no launches
+	if (stats){
+		*stats = summarize(std::vector<double>(), 0);
+	}
+	
+	std::cout << " Size of M x N x K: " 		<< M << "x" << N << "x" << K << std::endl;
+	if (trans_a || trans_b){
+		std::cout << " Layout: " 				<< layout_name(trans_a, trans_b) << std::endl;
+	}
+	std::cout << " Size of local mem: " 		<< size_t(config.local_mem) 	<< std::endl;
+	if (config.local_mem == 2){
+		std::cout << " Size of C tile: " 		<< config.tsm  << "x" << config.tsn  << std::endl;
+		std::cout << " Depth of K tile: " 		<< config.tsk  << std::endl;
+		std::cout << " Work per thread: " 		<< config.wptm << "x" << config.wptn << std::endl;
+	}
+	else {
+		std::cout << " Size of block sub matrix: " 	<< size_t(config.block_size) 	<< std::endl;
+	}
+	if (config.local_mem != 1){
+		std::cout << " Vector width: " 			<< config.vector_width << std::endl;
+	}
+	std::cout << " Edge tiles: " 				<< (config.edge_guard ? "guarded" : "padded") << std::endl;
+	
+	if (M <= 0 || N <= 0 || K <= 0){
+		std::cout << "	Matrix dimensions must be positive!" << std::endl;
+		return -1;
+	}
+   	
+   	if(!session.ready()){
+		std::cerr << "	Error. OpenCL session is not available!" << std::endl;
+		return -1;
+	}
+   	
+   	//Allocate host memory for matrices A and B, pinned and kept by the session pool
+   	unsigned int size_A = M * K;
+   	unsigned int mem_size_A = sizeof(float) * size_A;
+   	PinnedHost pinned_A(session.pool(), mem_size_A);
+   	float* h_A = pinned_A.get();
+ 
+   	unsigned int size_B = K * N;
+   	unsigned int mem_size_B = sizeof(float) * size_B;
+   	PinnedHost pinned_B(session.pool(), mem_size_B);
+   	float* h_B = pinned_B.get();
+   	if (!h_A || !h_B){
+   		return -1;
+   	}
+
+   	//Initialize host memory
+   	seedMatrix(h_A, size_A);
+   	seedMatrix(h_B, size_B);
+ 
+   	//Allocate host memory for the result C
+   	unsigned int size_C = M * N;
+   	unsigned int mem_size_C = sizeof(float) * size_C;
+   	PinnedHost pinned_C(session.pool(), mem_size_C);
+   	float* h_C = pinned_C.get();
+   	if (!h_C){
+   		return -1;
+   	}
+   	
+   	std::cout << "	Running matrix multiplication for matrices A (" << M 
+   			  << "x" << K << ")  and B (" << K << "x" << N << ") ...\n";
+   	
+   	// A transposed operand is stored the other way round
+   	int lda = trans_a ? M : K;
+   	int ldb = trans_b ? K : N;
+   	BenchmarkStats timing = summarize(std::vector<double>(), 0);
+   	double time = run_sgemm(session, config, trans_a, trans_b, M, N, K, 1.0f, h_A, lda, h_B, ldb,
+   							0.0f, h_C, N, bench, &timing);
+   	if (stats){
+   		*stats = timing;
+   	}
+   	if (time < 0){
+   		return -1;
+   	}
+   	
+   	// A run stopped by the cutoff of bench is already known to be too slow; it is not checked
+   	if (timing.aborted){
+   		printf("	Stopped after %d launches, slower than %.3f ms\n", timing.reps, bench->abort_ms);
+   		return time;
+   	}
     
     if(display){
     	printf("\n	Matrix A \n==========================\n");
-    	printMatrix(hostA_copy, dim);
+    	printMatrix(h_A, trans_a ? K : M, lda);
     	
     	printf("\n	Matrix B \n==========================\n");
-    	printMatrix(hostB_copy, dim);
+    	printMatrix(h_B, trans_b ? N : K, ldb);
     	
     	printf("\n	Matrix C \n==========================\n");
-    	printMatrix(hostC_copy, dim);
+    	printMatrix(h_C, M, N);
     }
     
-    // Display execution time
-    //std::cout << "	Kernel Execution Time (msec): " << (double)(end_time - start_time)/1000000.0 << std::endl;
-    
-    // Test for equality
-    clock_t clk_start, clk_end;
-    clk_start = clock();
-    for (int i = 0; i < dim; i++){
-		for (int j = 0; j < dim; j++){
-			h_copy[i*dim + j] = 0;
-			for (int k = 0; k < dim; k++){
-				h_copy[i*dim + j] += hostA_copy[i*dim + k] * hostB_copy[k*dim + j];
-				//h_copy[i*dim + j] += 2;
-			}
-		}
-	}
-	clk_end = clock();
-	//mtxO3 not mtx03
-	double mtxO3 = double(clk_end - clk_start)/(CLOCKS_PER_SEC);
-	//printf("	MtxO3 running time is: %f milliseconds\n", mtxO3*1000);
-	
-	int flag = 0;
-	clock_t compare_start, compare_end;
-	compare_start = clock();
-	for (int i = 0; i < dim; i++){
-		for (int j = 0; j < dim; j++){
-			
-			if(hostC_copy[i*dim + j] != h_copy[i*dim + j]){
-				flag = 1;
-				break;
-			}
-		}
-    }
-    compare_end = clock();
-    double mtx_compare = double(compare_end - compare_start)/(CLOCKS_PER_SEC);
+    // Check the result against the CPU reference
+    VerifyOptions check = verify ? *verify : default_verify_options(VERIFY_FULL);
+    std::vector<float> op_A, op_B;
+    if (trans_a && check.mode != VERIFY_NONE)
+    	op_A = transposed(h_A, K, M);
+    if (trans_b && check.mode != VERIFY_NONE)
+    	op_B = transposed(h_B, N, K);
+    VerifyResult verified = verify_sgemm(check, M, N, K, trans_a ? op_A.data() : h_A, K,
+    									 trans_b ? op_B.data() : h_B, N, h_C, N);
     
-    if (flag){
-    	printf("	The kernel matrix is not equal\n");
+    if (!verified.passed){
+    	printf("	The kernel matrix is not equal (error %.2f times the rounding bound)\n", verified.max_error);
     	return -1;
     }
-    else {
-    	printf("	The matrices are equal!\n");
-    	printf("	Kernel Execution Time is %f milliseconds\n", (double)(end_time - start_time)/1000000.0);
-    	printf("	MtxO3 running time is: %f milliseconds\n", mtxO3*1000);
-    	printf("	Comparison execution time is %f milliseconds\n", mtx_compare*1000);
-    	
-    }
     
-    //Shutdown and cleanup
-    free(h_A);
-   	free(h_B);
-   	free(h_C);
-   	free(h_test);
- 
-   	clReleaseMemObject(d_A);
-   	clReleaseMemObject(d_B);
-   	clReleaseMemObject(d_C);
-
-   	clReleaseProgram(program);
-   	clReleaseKernel(kernel);
-   	clReleaseCommandQueue(queue);
-   	clReleaseContext(context);
+    if (check.mode != VERIFY_NONE){
+    	printf("	The matrices are equal! (%s check, error %.2f of the rounding bound)\n",
+    		   verify_mode_name(check.mode), verified.max_error);
+    }
+    printf("	Kernel Execution Time is %f milliseconds\n", time);
+    printf("	Verification time is %f milliseconds\n", verified.ms);
    
    	return time;
    	
-}
\ No newline at end of file
+}
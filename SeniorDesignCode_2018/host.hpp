@@ -32,6 +32,9 @@
 #include <sys/stat.h>
 #include <stdbool.h>
 #include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 
 #ifdef __APPLE__
 #include <OpenCL/opencl.h>
@@ -39,10 +42,114 @@
 #include <CL/cl.h>
 #endif
 
+#include "session.hpp"
+#include "benchmark.hpp"
+#include "verify.hpp"
+
+// Kernel parameters passed to sgemm.cl as -D build options
+struct KernelConfig {
+	int local_mem;		// 0 = global memory, 1 = local memory blocks, 2 = register tiles
+	int block_size;		// BLOCK_SIZE x BLOCK_SIZE work-group  (local_mem == 1)
+	int tsm, tsn, tsk;	// C tile per work-group and K tile depth (local_mem == 2)
+	int wptm, wptn;		// C outputs per work-item along M and N (local_mem == 2)
+	int vector_width;	// floats per global load: 1, 2, 4 or 8 (local_mem == 0 or 2)
+	int edge_guard;		// 0 = pad edge tiles with zeros on the host, 1 = bounds checks
+};
+
+// Whether an operand is used as stored or transposed, as in BLAS
+enum Transpose { NO_TRANS = 0, TRANS = 1 };
+
+// "NN", "NT", "TN" or "TT", the layout names of the CSV files and the tuning database
+const char* layout_name(const Transpose trans_a, const Transpose trans_b);
+bool parse_layout(const std::string& name, Transpose& trans_a, Transpose& trans_b);
+
+KernelConfig make_config(int local_mem, int block_size, int vector_width = 1);
+KernelConfig make_config(int tsm, int tsn, int tsk, int wptm, int wptn, int vector_width = 1);
+std::string build_options(const KernelConfig& config, const int batched = 0,
+						  const Transpose trans_a = NO_TRANS, const Transpose trans_b = NO_TRANS,
+						  const int beta_zero = 1);
+bool check_config(const KernelConfig& config, const int display = 1);
+int work_group_size(const KernelConfig& config);
+int local_memory_bytes(const KernelConfig& config);
+bool config_fits(const KernelConfig& config, const DeviceInfo& device, const int display = 0);
+
+// Pieces of run_sgemm() shared with the pipelined sampler
+void padded_size(const KernelConfig& config, const int M, const int N, const int K,
+				 int& run_M, int& run_N, int& run_K);
+void launch_size(const KernelConfig& config, const int run_M, const int run_N,
+				 size_t* local, size_t* global);
+cl_int set_sgemm_args(cl_kernel kernel, cl_mem d_C, cl_mem d_A, cl_mem d_B,
+					  int run_M, int run_N, int run_K, int lda, int ldb, int ldc,
+					  float alpha = 1.0f, float beta = 0.0f);
+void copy_padded(const float* src, int rows, int cols, int ld,
+				 float* dst, int padded_rows, int padded_cols);
+
 void seedMatrix(float* data, int size);
 long LoadOpenCLKernel(char const* path, char **buf);
-void printMatrix(float* buffer, int dimension);
-double host(const int matrix_dim,  const int local_mem, 
-			const int block_size,  const int display);
+void printMatrix(float* buffer, int rows, int columns);
+double run_sgemm(Session& session,   const KernelConfig& config,
+				 const int M, const int N, const int K,
+				 const float* A, const int lda,
+				 const float* B, const int ldb,
+				 float* C,       const int ldc,
+				 const BenchmarkOptions* bench = NULL, BenchmarkStats* stats = NULL,
+				 const int display = 1);
+double run_sgemm(Session& session,   const KernelConfig& config,
+				 const Transpose trans_a, const Transpose trans_b,
+				 const int M, const int N, const int K, const float alpha,
+				 const float* A, const int lda,
+				 const float* B, const int ldb, const float beta,
+				 float* C,       const int ldc,
+				 const BenchmarkOptions* bench = NULL, BenchmarkStats* stats = NULL,
+				 const int display = 1);
+// B (K x N, row-major) padded for one configuration and uploaded once, for a multiply
+// whose row blocks are run one at a time on the same device (HeteroSgemm)
+class ResidentB {
+public:
+	ResidentB(Session& session, const KernelConfig& config, const int N, const int K,
+			  const float* B, const int ldb);
+	~ResidentB();
+
+	bool ready() const 	{ return uploaded; }
+
+private:
+	ResidentB(const ResidentB&);
+	ResidentB& operator=(const ResidentB&);
+
+	friend double run_sgemm_rows(const ResidentB& B, const int rows,
+								 const float* A, const int lda, float* C, const int ldc);
+
+	Session& 		session;
+	KernelConfig 	config;
+	int 			N, K;
+	int 			run_N, run_K, run_ldb;
+	cl_mem 			buffer;
+	bool 			uploaded;
+};
+
+// C (rows x N) = A (rows x K) * B with B already on the device; only A and C move.
+// One untimed launch; returns its kernel time in ms, -1 on failure.
+double run_sgemm_rows(const ResidentB& B, const int rows,
+					  const float* A, const int lda, float* C, const int ldc);
+
+double host(Session& session,       const int M, const int N, const int K,
+			const KernelConfig& config, const int display,
+			const BenchmarkOptions* bench = NULL, BenchmarkStats* stats = NULL,
+			const VerifyOptions* verify = NULL,
+			const Transpose trans_a = NO_TRANS, const Transpose trans_b = NO_TRANS);
+
+void print_inputs(const int M, const int N, const int K, const KernelConfig& config);
+void write_csv_header(std::ofstream& csv);
+void write_csv_row(std::ofstream& csv, const double time,
+				   const int M, const int N, const int K, const KernelConfig& config,
+				   const DeviceInfo* device = NULL, const int batch = 1,
+				   const Transpose trans_a = NO_TRANS, const Transpose trans_b = NO_TRANS,
+				   const PhaseTimes* phases = NULL);
+
+std::vector<double> config_features(const int M, const int N, const int K, const KernelConfig& config,
+									const DeviceInfo* device = NULL, const int batch = 1,
+									const Transpose trans_a = NO_TRANS, const Transpose trans_b = NO_TRANS);
+std::vector<std::string> config_feature_names();
+void enumerate_configs(std::vector<KernelConfig>& configs, const DeviceInfo* device = NULL);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,150 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: kernel_cache.cpp
+//	Function(s): cache_directory(), cache_key(), load_cached_program(),
+//				 store_cached_program()
+//
+//	Purpose: 	On-disk cache of compiled OpenCL program binaries. A program is stored
+//				under a hash of the kernel source, the build options, CL_DEVICE_NAME and
+//				CL_DRIVER_VERSION, so later runs can skip compiling from source. The
+//				directory defaults to ./.oclsgemm_cache and can be moved with the
+//				OCLSGEMM_CACHE_DIR environment variable or per Session.
+//
+/****************************************************************************************/
+
+#include "kernel_cache.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// 64-bit FNV-1a hash, chained across each part of the key
+static unsigned long long fnv1a(const std::string& data, unsigned long long hash)
+{
+	for (size_t i = 0; i < data.size(); i++){
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ULL;
+	}
+	// Separator so "ab"+"c" and "a"+"bc" hash differently
+	hash ^= 0xff;
+	hash *= 1099511628211ULL;
+	return hash;
+}
+
+std::string cache_directory()
+{
+	const char* dir = getenv("OCLSGEMM_CACHE_DIR");
+	if (dir && dir[0] != '\0')
+		return dir;
+	return ".oclsgemm_cache";
+}
+
+std::string cache_key(const std::string& source, const std::string& options,
+					  cl_device_id device)
+{
+	char device_name[1024] = "";
+	char driver_version[1024] = "";
+	clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(device_name), device_name, NULL);
+	clGetDeviceInfo(device, CL_DRIVER_VERSION, sizeof(driver_version), driver_version, NULL);
+
+	unsigned long long hash = 14695981039346656037ULL;
+	hash = fnv1a(source, hash);
+	hash = fnv1a(options, hash);
+	hash = fnv1a(device_name, hash);
+	hash = fnv1a(driver_version, hash);
+
+	char key[17];
+	sprintf(key, "%016llx", hash);
+	return key;
+}
+
+static std::string cache_path(const std::string& dir, const std::string& key)
+{
+	return dir + "/" + key + ".bin";
+}
+
+cl_program load_cached_program(cl_context context, cl_device_id device, const std::string& dir,
+							   const std::string& key, const std::string& options)
+{
+	std::ifstream file(cache_path(dir, key).c_str(), std::ios::binary);
+	if (!file)
+		return NULL;
+
+	std::stringstream contents;
+	contents << file.rdbuf();
+	std::string binary = contents.str();
+	if (binary.empty())
+		return NULL;
+
+	cl_int err, status;
+	size_t length = binary.size();
+	const unsigned char* data = (const unsigned char*) binary.data();
+	cl_program program = clCreateProgramWithBinary(context, 1, &device, &length, &data,
+												   &status, &err);
+	if (!program)
+		return NULL;
+	if (err != CL_SUCCESS || status != CL_SUCCESS){
+		// A binary of another driver is rejected but still gives back a program
+		clReleaseProgram(program);
+		return NULL;
+	}
+
+	// Binaries still need a (cheap) build before kernels can be created
+	err = clBuildProgram(program, 0, NULL, options.c_str(), NULL, NULL);
+	if (err != CL_SUCCESS){
+		clReleaseProgram(program);
+		return NULL;
+	}
+
+	return program;
+}
+
+bool store_cached_program(cl_program program, const std::string& dir, const std::string& key)
+{
+	size_t length = 0;
+	cl_int err = clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(length), &length, NULL);
+	if (err != CL_SUCCESS || length == 0)
+		return false;
+
+	std::vector<unsigned char> binary(length);
+	unsigned char* data = &binary[0];
+	err = clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(data), &data, NULL);
+	if (err != CL_SUCCESS)
+		return false;
+
+	mkdir(dir.c_str(), 0755);
+
+	// Write to a temporary file first so a crash never leaves a truncated binary
+	std::string path = cache_path(dir, key);
+	char suffix[32];
+	sprintf(suffix, ".%d.tmp", (int) getpid());
+	std::string temp = path + suffix;
+	std::ofstream file(temp.c_str(), std::ios::binary);
+	if (!file)
+		return false;
+	file.write((const char*) data, length);
+	file.close();
+	if (!file || rename(temp.c_str(), path.c_str()) != 0){
+		remove(temp.c_str());
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,39 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: kernel_cache.hpp
+//	Purpose of File: Header File for kernel_cache.cpp
+//
+/****************************************************************************************/
+
+#ifndef KERNEL_CACHE
+#define KERNEL_CACHE
+
+#include <string>
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+// OCLSGEMM_CACHE_DIR, or ./.oclsgemm_cache; the functions below take the directory
+std::string cache_directory();
+std::string cache_key(const std::string& source, const std::string& options,
+					  cl_device_id device);
+cl_program load_cached_program(cl_context context, cl_device_id device, const std::string& dir,
+							   const std::string& key, const std::string& options);
+bool store_cached_program(cl_program program, const std::string& dir, const std::string& key);
+
+#endif
@@ -21,6 +21,15 @@
 //				matrix multiplication on A and B. The result is displayed matrix C, and 
 //				the execution time in milliseconds of the kernel matrix multiplication.
 //
+//				The kernel parameters of a shape that has been tuned before are read
+//				from the tuning database (tuning_db.cpp) instead of being asked for.
+//
+//				Everything but the prompts lives in libautotune (autotune.hpp); this
+//				file and arg_parse.cpp are the command-line front end.
+//
+//				Each iteration is also appended to the results dataset (results.cpp),
+//				which keeps every run with its device, driver and statistics.
+//
 //				The program also has additional functionality that can be called through
 //				the terminal by ./program [-options] where [-options] are execution flags.
 //				For example ./program -h will provide the user helpful information about
@@ -28,7 +37,8 @@
 //					- OpenCL Device Query
 //					- Basic CPU Matrix Multiplication for comparison
 //					- Generating Kernel Parameter/Execution Datasets for Random Forest
-//					- Executing Python Random Forest scripts
+//					- Model-guided search for the best kernel configuration
+//					- Training the Random Forest performance model
 //
 /****************************************************************************************/
 
@@ -44,27 +54,18 @@
 #include <sys/stat.h>
 #include <stdbool.h>
 #include <iomanip>
+
+#ifdef __APPLE__
 #include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
 
-#include "devInfo.hpp"
-#include "host.hpp"
+#include "autotune.hpp"
 #include "arg_parse.hpp"
 
 using namespace std;
 
-//Function to display the matrices
-void printMatrix(float* buffer, int row, int column){
-	
-	for(int i = 0; i < row; i++){
-		for(int j = 0; j < column; j++){			
-			printf("%03.2f\t ", buffer[i*column+j]);
-		}
-		printf("\n");
-	}
-	printf("\n");
-	
-}
-
 int main(int argc, char** argv){
 
 	// Parse Program Arguments [options]
@@ -77,18 +78,18 @@ int main(int argc, char** argv){
 	csv.open(filename);
 	
 	// Inputs (Parameter Space)
-	int mtx_dim;
+	int mtx_m, mtx_n, mtx_k;
+	int edge_guard;
 	int local_mem;
 	int block_size;
+	int vector_width;
+	KernelConfig config;
 	
 	// Set Seed
 	srand(2018);
 	
 	//Generate the Headers for the CSV Table
-	csv << "Time"  << ",";
-	csv << "Matrix_Dim" << ",";
-	csv << "Local_Mem" 	<< ",";
-	csv << "Block_Size" << "\n";
+	write_csv_header(csv);
 	
 	//Ask for size of dataset
 	int sample_size;
@@ -96,26 +97,66 @@ int main(int argc, char** argv){
 	cin  >> sample_size;
 		
 	// Ask for size of matrix
-	cout << "What is the X and Y dimensions that you want for the Matrices?: ";
-	cin  >> mtx_dim;
-	cout << " Matrix A and B are both (" << mtx_dim << ") x (" << mtx_dim << ") " << endl;
+	cout << "What are the M, N and K dimensions that you want for the Matrices?: ";
+	cin  >> mtx_m >> mtx_n >> mtx_k;
+	cout << " Matrix A is (" << mtx_m << ") x (" << mtx_k << ") and B is ("
+		 << mtx_k << ") x (" << mtx_n << ") " << endl;
 	
-	// Ask for local or global memory
-	cout << "Execute on local memory? " << endl;
-	cout << "	>>> Enter 1 for yes, Enter 0 for no: ";
-	cin  >> local_mem;
+	// One OpenCL session and tuning database (libautotune) reused by every iteration
+	Autotuner autotuner;
+	if (!autotuner.ready()){
+		csv.close();
+		return 1;
+	}
+	Session& session = autotuner.session();
+	TuningDB& db = autotuner.database();
 	
-	if(local_mem){
-		// Ask for block size
-		cout << "Enter block size (must be less than matrix dimensions): " << endl;
-		cin  >> block_size;
-		if (block_size > mtx_dim){
-			cerr << "Error: Block_Size must be less than Matrix Dimensions! " << endl;
-			block_size = floor(block_size/mtx_dim);
-		}
+	// Every iteration is also appended to the results dataset
+	ResultsWriter results;
+	results.open(results_name(), session.info());
+	
+	// Use the tuned configuration of this shape when there is one
+	std::string device = device_identity(session.device());
+	TuningSource tuned = db.lookup(device, mtx_m, mtx_n, mtx_k, config);
+	if (tuned != TUNED_NONE){
+		cout << "Using the " << tuning_source_name(tuned) << " configuration (" << tuning_db_path() << ")" << endl;
 	}
-	else{
-		block_size = 1;
+	else {
+		// Ask for local or global memory
+		cout << "Execute on local memory? " << endl;
+		cout << "	>>> Enter 1 for yes, Enter 0 for no, Enter 2 for register tiles: ";
+		cin  >> local_mem;
+	
+		if(local_mem == 2){
+			// Ask for the register tile shape
+			int tsm, tsn, tsk, wptm, wptn;
+			cout << "Enter tile sizes TSM TSN TSK (e.g. 64 64 16): " << endl;
+			cin  >> tsm >> tsn >> tsk;
+			cout << "Enter work per thread WPTM WPTN (e.g. 4 4): " << endl;
+			cin  >> wptm >> wptn;
+			cout << "Enter vector width (1, 2, 4 or 8): " << endl;
+			cin  >> vector_width;
+			block_size = 1;
+			config = make_config(tsm, tsn, tsk, wptm, wptn, vector_width);
+		}
+		else if(local_mem){
+			// Ask for block size
+			cout << "Enter block size: " << endl;
+			cin  >> block_size;
+			config = make_config(local_mem, block_size);
+		}
+		else{
+			cout << "Enter vector width (1, 2, 4 or 8): " << endl;
+			cin  >> vector_width;
+			block_size = 1;
+			config = make_config(local_mem, block_size, vector_width);
+		}
+	
+		// Ask how to handle tiles that run past the edge of the matrices
+		cout << "Guard edge tiles in the kernel instead of padding the matrices?" << endl;
+		cout << "	>>> Enter 1 for yes, Enter 0 for no: ";
+		cin  >> edge_guard;
+		config.edge_guard = edge_guard ? 1 : 0;
 	}
 	
 	// Set display to True
@@ -124,35 +165,45 @@ int main(int argc, char** argv){
 	cout << "	>>> Enter 1 for yes, Enter 0 for no: ";
 	cin  >> display;
 	
+	// Each iteration reports the median of repeated launches
+	BenchmarkOptions bench = default_benchmark_options();
+	
 	//Main Loop
 	for(int i = 0; i < sample_size; i++){
 		
-		//Test for Inputs Sets
-		int x1 = mtx_dim;
-		int x2 = local_mem;
-		int x3 = block_size;
-		
 		// Display the input for following iteration	
 		printf("Iteration %d\n", i);
-		printf("	Inputs:  [%d, %d, %d]\n", x1, x2, x3);
+		print_inputs(mtx_m, mtx_n, mtx_k, config);
 
 		// Execute the Kernel from Host Code and Obtain the Execution Time
-		double kernel_time = host(x1,x2,x3,display);
+		BenchmarkStats stats = summarize(std::vector<double>(), 0);
+		double kernel_time = host(session, mtx_m, mtx_n, mtx_k, config, display, &bench, &stats);
 		printf("	Outputs (ms): [%.3f]\n", kernel_time);
 		
 		// Output the results to CSV file
-		csv << kernel_time << ",";
-		csv << x1 << ",";
-		csv << x2 << ",";
-		csv << x3 << "\n";
+		write_csv_row(csv, kernel_time, mtx_m, mtx_n, mtx_k, config, session.info(),
+					  1, NO_TRANS, NO_TRANS, &stats.phases);
+		results.append(make_record("run", kernel_time, mtx_m, mtx_n, mtx_k, config, &stats));
+		
+		// Keep the configuration if it is the fastest seen for this shape
+		db.record(device, mtx_m, mtx_n, mtx_k, config, kernel_time);
 		
 	}
 	
+	if (!db.save()){
+		cerr << "	Warning. Could not write " << tuning_db_path() << endl;
+	}
+	
 	//Close CSV File
 	csv.close();
+	results.close();
 	
 	// Display Successful Execution
 	cout << "Success! Results are saved in " << filename << "." << endl;
+	if (results.rows() > 0){
+		cout << results.rows() << " results are appended to " << results.dataset() << ".jsonl and "
+			 << results.dataset() << ".bin." << endl;
+	}
 
 	return 0;
 }
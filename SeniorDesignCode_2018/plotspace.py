@@ -37,10 +37,11 @@ def main():
 	data = pd.read_csv('kernel_dataset.csv')
 
 	data_x = data.iloc[:,1:]	# x - input values are the all N rows and the cols from 1 to N
+	data_x = data_x[[c for c in data_x.columns if not c.endswith('_ms')]]	# phase timings are not inputs
 	data_y = data.iloc[:,0]		# y - output values are the all N rows and the column 0
 	
-	blk_x = data.iloc[:,3] # x - block size values 
-	blk_y = data.iloc[:,0] # y - matrix execution time
+	blk_x = data['Block_Size'] # x - block size values 
+	blk_y = data['Time'] 		# y - matrix execution time
 
 
 	# Plot the Relationship Between Matrix Size and Execution Time
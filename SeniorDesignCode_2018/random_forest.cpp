@@ -0,0 +1,253 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: random_forest.cpp
+//	Function(s): RandomForest::fit(), RandomForest::predict(), RandomForest::score(),
+//				 load_dataset()
+//
+//	Purpose: 	Native random forest regressor used as the kernel performance model.
+//				It is trained on the samples generate_samples() writes and answers
+//				predictions in process, so candidate configurations can be ranked
+//				without launching them.
+//
+/****************************************************************************************/
+
+#include "random_forest.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <thread>
+#include <cstdlib>
+
+RandomForest::RandomForest(int n_trees, int max_depth, int min_samples_leaf,
+						   int max_features, unsigned int seed)
+	: n_trees(n_trees), max_depth(max_depth), min_samples_leaf(min_samples_leaf),
+	  max_features(max_features), seed(seed)
+{
+}
+
+void RandomForest::fit(const std::vector<Sample>& X, const std::vector<double>& y, int n_threads)
+{
+	trees.assign(n_trees, Tree());
+	if (X.empty())
+		return;
+
+	if (n_threads <= 0)
+		n_threads = std::max(1u, std::thread::hardware_concurrency());
+	n_threads = std::min(n_threads, n_trees);
+
+	// Each thread grows every n_threads-th tree; trees only read the shared data
+	std::vector<std::thread> workers;
+	for (int t = 0; t < n_threads; t++){
+		workers.push_back(std::thread([this, t, n_threads, &X, &y]() {
+			for (int i = t; i < n_trees; i += n_threads)
+				grow_tree(trees[i], X, y, seed + 7919u * i);
+		}));
+	}
+	for (size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+}
+
+void RandomForest::grow_tree(Tree& tree, const std::vector<Sample>& X,
+							 const std::vector<double>& y, unsigned int tree_seed) const
+{
+	std::mt19937 rng(tree_seed);
+	const int n = (int) X.size();
+	const int n_features = (int) X[0].size();
+	const int try_features = (max_features <= 0 || max_features > n_features) ? n_features : max_features;
+
+	// Bootstrap sample of the training rows
+	std::vector<int> rows(n);
+	std::uniform_int_distribution<int> pick(0, n - 1);
+	for (int i = 0; i < n; i++)
+		rows[i] = pick(rng);
+
+	std::vector<int> features(n_features);
+	for (int f = 0; f < n_features; f++)
+		features[f] = f;
+
+	// Grow depth-first with an explicit stack of (node, first row, last row, depth)
+	struct Pending { int node, begin, end, depth; };
+	std::vector<Pending> stack;
+	tree.clear();
+	tree.push_back(Node());
+	Pending root = {0, 0, n, 0};
+	stack.push_back(root);
+
+	std::vector<std::pair<double, double> > sorted;
+	while (!stack.empty()){
+		Pending job = stack.back();
+		stack.pop_back();
+
+		double sum = 0.0, sum_sq = 0.0;
+		for (int i = job.begin; i < job.end; i++){
+			sum += y[rows[i]];
+			sum_sq += y[rows[i]] * y[rows[i]];
+		}
+		const int count = job.end - job.begin;
+		Node& node = tree[job.node];
+		node.feature = -1;
+		node.threshold = 0.0;
+		node.left = node.right = -1;
+		node.value = sum / count;
+
+		double node_sse = sum_sq - sum * sum / count;
+		if (job.depth >= max_depth || count < 2 * min_samples_leaf || node_sse <= 1e-12)
+			continue;
+
+		// Best split over a random subset of the features, by sum of squared errors
+		std::shuffle(features.begin(), features.end(), rng);
+		int best_feature = -1;
+		double best_threshold = 0.0;
+		double best_sse = node_sse;
+		for (int fi = 0; fi < try_features; fi++){
+			int f = features[fi];
+			sorted.clear();
+			for (int i = job.begin; i < job.end; i++)
+				sorted.push_back(std::make_pair(X[rows[i]][f], y[rows[i]]));
+			std::sort(sorted.begin(), sorted.end());
+
+			double left_sum = 0.0, left_sq = 0.0;
+			for (int i = 0; i < count - 1; i++){
+				left_sum += sorted[i].second;
+				left_sq  += sorted[i].second * sorted[i].second;
+				int left_count = i + 1;
+				int right_count = count - left_count;
+				if (sorted[i].first == sorted[i + 1].first)
+					continue;
+				if (left_count < min_samples_leaf || right_count < min_samples_leaf)
+					continue;
+				double right_sum = sum - left_sum;
+				double right_sq = sum_sq - left_sq;
+				double sse = (left_sq - left_sum * left_sum / left_count) +
+							 (right_sq - right_sum * right_sum / right_count);
+				if (sse < best_sse - 1e-12){
+					best_sse = sse;
+					best_feature = f;
+					best_threshold = 0.5 * (sorted[i].first + sorted[i + 1].first);
+				}
+			}
+		}
+		if (best_feature < 0)
+			continue;
+
+		// Partition the rows of this node around the threshold
+		int mid = job.begin;
+		for (int i = job.begin; i < job.end; i++){
+			if (X[rows[i]][best_feature] <= best_threshold)
+				std::swap(rows[i], rows[mid++]);
+		}
+
+		int left = (int) tree.size();
+		tree.push_back(Node());
+		tree.push_back(Node());
+		tree[job.node].feature = best_feature;
+		tree[job.node].threshold = best_threshold;
+		tree[job.node].left = left;
+		tree[job.node].right = left + 1;
+
+		Pending left_job = {left, job.begin, mid, job.depth + 1};
+		Pending right_job = {left + 1, mid, job.end, job.depth + 1};
+		stack.push_back(right_job);
+		stack.push_back(left_job);
+	}
+}
+
+double RandomForest::predict_tree(const Tree& tree, const Sample& x) const
+{
+	int node = 0;
+	while (tree[node].feature >= 0)
+		node = x[tree[node].feature] <= tree[node].threshold ? tree[node].left : tree[node].right;
+	return tree[node].value;
+}
+
+double RandomForest::predict(const Sample& x) const
+{
+	if (trees.empty())
+		return 0.0;
+
+	double sum = 0.0;
+	for (size_t t = 0; t < trees.size(); t++)
+		sum += predict_tree(trees[t], x);
+	return sum / trees.size();
+}
+
+void RandomForest::predict_trees(const Sample& x, std::vector<double>& out) const
+{
+	out.resize(trees.size());
+	for (size_t t = 0; t < trees.size(); t++)
+		out[t] = predict_tree(trees[t], x);
+}
+
+double RandomForest::score(const std::vector<Sample>& X, const std::vector<double>& y) const
+{
+	if (y.empty())
+		return 0.0;
+
+	double mean = 0.0;
+	for (size_t i = 0; i < y.size(); i++)
+		mean += y[i];
+	mean /= y.size();
+
+	double ss_res = 0.0, ss_tot = 0.0;
+	for (size_t i = 0; i < y.size(); i++){
+		double err = y[i] - predict(X[i]);
+		ss_res += err * err;
+		ss_tot += (y[i] - mean) * (y[i] - mean);
+	}
+	return ss_tot > 0.0 ? 1.0 - ss_res / ss_tot : 0.0;
+}
+
+bool load_dataset(const std::string& filename, std::vector<Sample>& X, std::vector<double>& y,
+				  std::vector<std::string>& columns)
+{
+	std::ifstream csv(filename.c_str());
+	if (!csv)
+		return false;
+
+	X.clear();
+	y.clear();
+	columns.clear();
+
+	std::string line, cell;
+	if (!std::getline(csv, line))
+		return false;
+	// Phase timings (columns ending in _ms) describe a run, they are not inputs
+	std::stringstream header(line);
+	std::vector<bool> input;
+	while (std::getline(header, cell, ',')){
+		bool timing = cell.size() > 3 && cell.compare(cell.size() - 3, 3, "_ms") == 0;
+		input.push_back(input.empty() || !timing);
+		if (input.back())
+			columns.push_back(cell);
+	}
+
+	while (std::getline(csv, line)){
+		if (line.empty())
+			continue;
+		std::stringstream row(line);
+		std::vector<double> values;
+		for (size_t i = 0; std::getline(row, cell, ','); i++){
+			if (i < input.size() && input[i])
+				values.push_back(atof(cell.c_str()));
+		}
+		if (values.size() != columns.size() || values[0] < 0)
+			continue;
+		y.push_back(values[0]);
+		X.push_back(Sample(values.begin() + 1, values.end()));
+	}
+	return true;
+}
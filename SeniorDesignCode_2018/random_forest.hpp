@@ -0,0 +1,77 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: random_forest.hpp
+//	Purpose of File: Header File for random_forest.cpp
+//
+/****************************************************************************************/
+
+#ifndef RANDOM_FOREST
+#define RANDOM_FOREST
+
+#include <string>
+#include <vector>
+
+typedef std::vector<double> Sample;
+
+// Regression forest of CART trees, each grown on a bootstrap sample of the data
+// (the same model plotspace.py fits with sklearn's RandomForestRegressor).
+class RandomForest {
+public:
+	RandomForest(int n_trees = 100, int max_depth = 32, int min_samples_leaf = 1,
+				 int max_features = 0, unsigned int seed = 2018);
+
+	// Grow the trees in parallel; n_threads = 0 uses every core
+	void fit(const std::vector<Sample>& X, const std::vector<double>& y, int n_threads = 0);
+
+	// Mean of the tree predictions
+	double predict(const Sample& x) const;
+
+	// Prediction of every tree, for the spread of the forest around its mean
+	void predict_trees(const Sample& x, std::vector<double>& out) const;
+
+	// Coefficient of determination R^2 on a test set
+	double score(const std::vector<Sample>& X, const std::vector<double>& y) const;
+
+	bool trained() const 	{ return !trees.empty(); }
+	int size() const 		{ return (int) trees.size(); }
+
+private:
+	struct Node {
+		int 	feature;	// -1 for a leaf
+		double 	threshold;	// go left when x[feature] <= threshold
+		int 	left, right;
+		double 	value;		// mean target of the samples that reached the node
+	};
+	typedef std::vector<Node> Tree;
+
+	void grow_tree(Tree& tree, const std::vector<Sample>& X, const std::vector<double>& y,
+				   unsigned int tree_seed) const;
+	double predict_tree(const Tree& tree, const Sample& x) const;
+
+	int n_trees;
+	int max_depth;
+	int min_samples_leaf;
+	int max_features;
+	unsigned int seed;
+
+	std::vector<Tree> trees;
+};
+
+// Read a sample CSV (Time first, then the inputs); failed samples (Time < 0) are skipped
+// and the per-phase timing columns (*_ms) are left out of the inputs
+bool load_dataset(const std::string& filename, std::vector<Sample>& X, std::vector<double>& y,
+				  std::vector<std::string>& columns);
+
+#endif
@@ -0,0 +1,433 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: results.cpp
+//	Function(s): results_name(), make_record(), ResultsWriter::open(),
+//				 ResultsWriter::append(), ResultsWriter::flush(), ResultsWriter::close(),
+//				 load_results()
+//
+//	Purpose: 	Results dataset shared by every mode. The CSV files of a run are
+//				truncated each time and only hold the model inputs, so a long sweep
+//				that dies loses everything and nothing says which driver produced a
+//				time. Here every measurement is appended to a named dataset with the
+//				device, the driver, all kernel parameters, the phases of the run and
+//				the statistics of its launches. The JSON Lines file can be followed
+//				while a sweep runs; the binary file keeps the same numbers as
+//				fixed-width rows of doubles, naming the columns once per run, so the
+//				model trainer can load millions of samples without parsing text.
+//
+/****************************************************************************************/
+
+#include "results.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+static const unsigned int format_version = 2;
+static const size_t segment_header = 4 * sizeof(unsigned int);
+static const size_t row_header = 2 * sizeof(unsigned int);
+
+std::string results_name()
+{
+	const char* name = getenv("OCLSGEMM_RESULTS");
+	if (name && name[0] != '\0')
+		return name;
+	return "oclsgemm_results";
+}
+
+ResultRecord make_record(const char* source, const double time,
+						 const int M, const int N, const int K, const KernelConfig& config,
+						 const BenchmarkStats* stats, const int batch,
+						 const Transpose trans_a, const Transpose trans_b)
+{
+	ResultRecord record;
+	record.source 	= source;
+	record.M 		= M;
+	record.N 		= N;
+	record.K 		= K;
+	record.batch 	= batch;
+	record.trans_a 	= trans_a;
+	record.trans_b 	= trans_b;
+	record.config 	= config;
+	record.time 	= time;
+	record.stats 	= stats ? *stats : summarize(std::vector<double>(), 0);
+	record.verified = -1;
+	return record;
+}
+
+// Numeric columns of the binary file: the time, the model inputs, then the run
+static std::vector<std::string> result_columns()
+{
+	static const char* run_columns[] = {"Build_ms", "Host_ms", "Upload_ms", "Download_ms",
+										"End_To_End_ms", "Reps", "Min_ms", "Median_ms",
+										"Mean_ms", "Stddev_ms", "P95_ms", "CI_Low_ms",
+										"CI_High_ms", "Aborted", "Verified", "Unix_Time"};
+	std::vector<std::string> columns(1, "Time");
+	std::vector<std::string> inputs = config_feature_names();
+	columns.insert(columns.end(), inputs.begin(), inputs.end());
+	columns.insert(columns.end(), run_columns, run_columns + 16);
+	return columns;
+}
+
+static std::vector<double> result_values(const ResultRecord& record, const DeviceInfo* device,
+										 const time_t now)
+{
+	const BenchmarkStats& s = record.stats;
+	std::vector<double> values(1, record.time);
+	std::vector<double> inputs = config_features(record.M, record.N, record.K, record.config,
+												 device, record.batch, record.trans_a, record.trans_b);
+	values.insert(values.end(), inputs.begin(), inputs.end());
+
+	double run[] = {s.phases.build, s.phases.host, s.phases.upload, s.phases.download,
+					end_to_end(s.phases), (double) s.reps, s.min, s.median, s.mean, s.stddev,
+					s.p95, s.ci_low, s.ci_high, s.aborted ? 1.0 : 0.0, (double) record.verified,
+					(double) now};
+	values.insert(values.end(), run, run + 16);
+	return values;
+}
+
+static void write_json_string(FILE* file, const std::string& text)
+{
+	fputc('"', file);
+	for (size_t i = 0; i < text.size(); i++){
+		unsigned char c = text[i];
+		if (c == '"' || c == '\\')
+			fprintf(file, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(file, "\\u%04x", c);
+		else
+			fputc(c, file);
+	}
+	fputc('"', file);
+}
+
+static void put_uint(std::string& bytes, const unsigned int value)
+{
+	bytes.append((const char*) &value, sizeof(value));
+}
+
+static unsigned int get_uint(const std::string& bytes, const size_t pos)
+{
+	unsigned int value;
+	memcpy(&value, bytes.data() + pos, sizeof(value));
+	return value;
+}
+
+// Column names of the rows that follow a segment header
+struct Segment {
+	bool 						described;	// false before the first header
+	std::vector<std::string> 	names;
+};
+
+enum ChunkStatus {
+	CHUNK_HEADER,
+	CHUNK_ROW,
+	CHUNK_END,		// clean end of the file
+	CHUNK_TORN,		// the header or row runs past the end: a crash
+	CHUNK_BAD		// another version, or corrupt; nothing after it can be trusted
+};
+
+// Next segment header or row of a file of size bytes; a row is read into row
+static ChunkStatus read_chunk(FILE* file, const long size, Segment& segment,
+							  std::vector<double>& row)
+{
+	long start = ftell(file);
+	if (start >= size)
+		return CHUNK_END;
+	if (size - start < (long) row_header)
+		return CHUNK_TORN;
+
+	std::string chunk(row_header, '\0');
+	if (fread(&chunk[0], 1, row_header, file) != row_header)
+		return CHUNK_TORN;
+
+	if (chunk.compare(0, 4, "OSGR") == 0){
+		size_t columns = segment.names.size();
+		if (!segment.described || get_uint(chunk, 4) != columns)
+			return CHUNK_BAD;
+		if (size - start < (long) (row_header + columns * sizeof(double)))
+			return CHUNK_TORN;
+		row.resize(columns);
+		if (columns > 0 && fread(&row[0], sizeof(double), columns, file) != columns)
+			return CHUNK_TORN;
+		return CHUNK_ROW;
+	}
+
+	if (chunk.compare(0, 4, "OSGS") != 0 || get_uint(chunk, 4) != format_version)
+		return CHUNK_BAD;
+	if (size - start < (long) segment_header)
+		return CHUNK_TORN;
+	chunk.resize(segment_header);
+	if (fread(&chunk[row_header], 1, segment_header - row_header, file) != segment_header - row_header)
+		return CHUNK_TORN;
+	unsigned int bytes = get_uint(chunk, 8);
+	unsigned int columns = get_uint(chunk, 12);
+	if (bytes < segment_header + 4 || bytes % sizeof(double) != 0)
+		return CHUNK_BAD;
+	if (size - start < (long) bytes)
+		return CHUNK_TORN;
+	chunk.resize(bytes);
+	if (fread(&chunk[segment_header], 1, bytes - segment_header, file) != bytes - segment_header)
+		return CHUNK_TORN;
+	if (chunk.compare(bytes - 4, 4, "OSGE") != 0)
+		return CHUNK_BAD;
+
+	// Device name and driver first, then the column names, then padding
+	size_t end = bytes - 4;
+	size_t pos = segment_header;
+	segment.names.clear();
+	for (unsigned int i = 0; i < columns + 2; i++){
+		size_t nul = chunk.find('\0', pos);
+		if (nul == std::string::npos || nul >= end)
+			return CHUNK_BAD;
+		if (i >= 2)
+			segment.names.push_back(chunk.substr(pos, nul - pos));
+		pos = nul + 1;
+	}
+	if (chunk.find_first_not_of('\0', pos) < end)
+		return CHUNK_BAD;
+	segment.described = true;
+	return CHUNK_HEADER;
+}
+
+static long file_size(FILE* file)
+{
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	return size;
+}
+
+ResultsWriter::ResultsWriter()
+	: device(NULL), json(NULL), binary(NULL), described(false), appended(0), synced(0)
+{
+}
+
+ResultsWriter::~ResultsWriter()
+{
+	close();
+}
+
+bool ResultsWriter::open(const std::string& dataset, const DeviceInfo* info)
+{
+	close();
+	name 		= dataset;
+	device 		= info;
+	described 	= false;
+	appended 	= 0;
+	columns 	= result_columns();
+
+	// Cut a header or row torn by a crash off the end, or every later row would be lost
+	// too. Anything else this version cannot read is not a crash: the file is left as it
+	// is and nothing is appended.
+	std::string bin_path = name + ".bin";
+	FILE* existing = fopen(bin_path.c_str(), "rb");
+	if (existing){
+		Segment segment;
+		segment.described = false;
+		std::vector<double> row;
+		long size = file_size(existing);
+		long valid = 0;
+		ChunkStatus status;
+		while ((status = read_chunk(existing, size, segment, row)) == CHUNK_HEADER ||
+			   status == CHUNK_ROW)
+			valid = ftell(existing);
+		fclose(existing);
+		if (status == CHUNK_BAD){
+			std::cerr << "	Error. " << bin_path << " has data this version cannot read at byte "
+					  << valid << ", it is left as it is!" << std::endl;
+			return false;
+		}
+		if (status == CHUNK_TORN && truncate(bin_path.c_str(), valid) != 0){
+			std::cerr << "	Error. Could not repair " << bin_path << "!" << std::endl;
+			return false;
+		}
+	}
+
+	// A torn last line stays behind as one malformed line; the next record starts fresh
+	std::string json_path = name + ".jsonl";
+	bool torn = false;
+	existing = fopen(json_path.c_str(), "rb");
+	if (existing){
+		torn = fseek(existing, -1, SEEK_END) == 0 && fgetc(existing) != '\n';
+		fclose(existing);
+	}
+
+	json 	= fopen(json_path.c_str(), "ab");
+	binary 	= fopen(bin_path.c_str(), "ab");
+	if (!json || !binary){
+		std::cerr << "	Error. Could not open the results dataset " << name << "!" << std::endl;
+		close();
+		return false;
+	}
+	if (torn)
+		fputc('\n', json);
+	return true;
+}
+
+bool ResultsWriter::append(const ResultRecord& record)
+{
+	if (!json)
+		return false;
+
+	time_t now = time(NULL);
+	const KernelConfig& c = record.config;
+	const BenchmarkStats& s = record.stats;
+
+	fprintf(json, "{\"source\":");
+	write_json_string(json, record.source);
+	fprintf(json, ",\"unix_time\":%lld,\"device\":", (long long) now);
+	write_json_string(json, device ? device->name : "unknown");
+	fprintf(json, ",\"vendor\":");
+	write_json_string(json, device ? device->vendor : "unknown");
+	fprintf(json, ",\"driver\":");
+	write_json_string(json, device ? device->driver : "unknown");
+	fprintf(json, ",\"M\":%d,\"N\":%d,\"K\":%d,\"batch\":%d,\"layout\":\"%s\"",
+			record.M, record.N, record.K, record.batch, layout_name(record.trans_a, record.trans_b));
+	fprintf(json, ",\"params\":{\"LOCAL_MEM\":%d,\"BLOCK_SIZE\":%d,\"TSM\":%d,\"TSN\":%d,\"TSK\":%d,"
+			"\"WPTM\":%d,\"WPTN\":%d,\"VECTOR_WIDTH\":%d,\"EDGE_GUARD\":%d}",
+			c.local_mem, c.block_size, c.tsm, c.tsn, c.tsk, c.wptm, c.wptn, c.vector_width, c.edge_guard);
+	fprintf(json, ",\"time_ms\":%.9g", record.time);
+	fprintf(json, ",\"phases\":{\"build_ms\":%.9g,\"host_ms\":%.9g,\"upload_ms\":%.9g,"
+			"\"kernel_ms\":%.9g,\"download_ms\":%.9g,\"end_to_end_ms\":%.9g}",
+			s.phases.build, s.phases.host, s.phases.upload, s.phases.kernel, s.phases.download,
+			end_to_end(s.phases));
+	fprintf(json, ",\"stats\":{\"reps\":%d,\"min_ms\":%.9g,\"median_ms\":%.9g,\"mean_ms\":%.9g,"
+			"\"stddev_ms\":%.9g,\"p95_ms\":%.9g,\"ci_low_ms\":%.9g,\"ci_high_ms\":%.9g,"
+			"\"rel_error\":%.9g,\"aborted\":%s}",
+			s.reps, s.min, s.median, s.mean, s.stddev, s.p95, s.ci_low, s.ci_high, s.rel_error,
+			s.aborted ? "true" : "false");
+	fprintf(json, ",\"verified\":%s}\n",
+			record.verified < 0 ? "null" : (record.verified ? "true" : "false"));
+	if (fflush(json) != 0)
+		return false;
+
+	// The first row of each open() follows a header naming the columns
+	std::string chunk;
+	if (!described){
+		chunk.append("OSGS");
+		put_uint(chunk, format_version);
+		put_uint(chunk, 0);		// bytes, filled in below
+		put_uint(chunk, columns.size());
+		chunk.append(device ? device->name : "unknown");
+		chunk.push_back('\0');
+		chunk.append(device ? device->driver : "unknown");
+		chunk.push_back('\0');
+		for (size_t i = 0; i < columns.size(); i++){
+			chunk.append(columns[i]);
+			chunk.push_back('\0');
+		}
+		chunk.append((sizeof(double) - (chunk.size() + 4) % sizeof(double)) % sizeof(double), '\0');
+		chunk.append("OSGE");
+		unsigned int bytes = chunk.size();
+		memcpy(&chunk[8], &bytes, sizeof(bytes));
+	}
+	std::vector<double> values = result_values(record, device, now);
+	chunk.append("OSGR");
+	put_uint(chunk, values.size());
+	chunk.append((const char*) &values[0], values.size() * sizeof(double));
+
+	// One write per record, out of the process before the next one starts. That is
+	// enough to survive a crash; the sync that survives a power cut costs far more,
+	// so it is done at most once a second
+	bool written = fwrite(chunk.data(), 1, chunk.size(), binary) == chunk.size();
+	written = fflush(binary) == 0 && written;
+	if (!written){
+		std::cerr << "	Error. Could not write " << name << ".bin!" << std::endl;
+		return false;
+	}
+	described = true;
+	appended++;
+	if (now != synced)
+		flush();
+	return true;
+}
+
+bool ResultsWriter::flush()
+{
+	if (!json)
+		return false;
+	synced = time(NULL);
+	return fsync(fileno(json)) == 0 && fsync(fileno(binary)) == 0;
+}
+
+void ResultsWriter::close()
+{
+	flush();
+	if (json)
+		fclose(json);
+	if (binary)
+		fclose(binary);
+	json = NULL;
+	binary = NULL;
+}
+
+bool load_results(const std::string& path, std::vector<Sample>& X, std::vector<double>& y,
+				  std::vector<std::string>& columns)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file)
+		return false;
+
+	X.clear();
+	y.clear();
+	std::vector<std::string> inputs = config_feature_names();
+	columns.assign(1, "Time");
+	columns.insert(columns.end(), inputs.begin(), inputs.end());
+
+	Segment segment;
+	segment.described = false;
+	std::vector<double> row;
+	std::vector<int> index;
+	int aborted = -1;
+	long size = file_size(file);
+	ChunkStatus status;
+	while ((status = read_chunk(file, size, segment, row)) == CHUNK_HEADER || status == CHUNK_ROW){
+
+		// Columns are found by name once per segment, so rows of older layouts still load
+		if (status == CHUNK_HEADER){
+			const std::vector<std::string>& names = segment.names;
+			index.assign(columns.size(), -1);
+			aborted = -1;
+			for (size_t n = 0; n < names.size(); n++){
+				for (size_t c = 0; c < columns.size(); c++){
+					if (names[n] == columns[c])
+						index[c] = n;
+				}
+				if (names[n] == "Aborted")
+					aborted = n;
+			}
+			continue;
+		}
+
+		// A run stopped early only timed its first, cold launch
+		if (index[0] < 0 || row[index[0]] < 0 || (aborted >= 0 && row[aborted] != 0))
+			continue;
+		Sample x(inputs.size(), 0.0);
+		for (size_t c = 1; c < columns.size(); c++){
+			if (index[c] >= 0)
+				x[c - 1] = row[index[c]];
+		}
+		y.push_back(row[index[0]]);
+		X.push_back(x);
+	}
+	if (status == CHUNK_BAD){
+		std::cerr << "	Warning. " << path << " has data this version cannot read, "
+				  << "only the samples before it are loaded" << std::endl;
+	}
+	fclose(file);
+	return true;
+}
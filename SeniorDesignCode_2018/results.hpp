@@ -0,0 +1,102 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: results.hpp
+//	Purpose of File: Header File for results.cpp
+//
+/****************************************************************************************/
+
+#ifndef RESULTS
+#define RESULTS
+
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "host.hpp"
+#include "random_forest.hpp"
+
+// OCLSGEMM_RESULTS, or "oclsgemm_results"; the dataset is NAME.jsonl and NAME.bin
+std::string results_name();
+
+// One measurement and everything needed to reproduce it
+struct ResultRecord {
+	const char* 	source;		// "run", "sample", "sweep" or "tune"
+	int 			M, N, K;
+	int 			batch;
+	Transpose 		trans_a, trans_b;
+	KernelConfig 	config;
+	double 			time;		// ms, -1 if it failed
+	BenchmarkStats 	stats;		// reps is 0 when only the time is known
+	int 			verified;	// 1 passed, 0 failed, -1 not reported
+};
+
+ResultRecord make_record(const char* source, const double time,
+						 const int M, const int N, const int K, const KernelConfig& config,
+						 const BenchmarkStats* stats = NULL, const int batch = 1,
+						 const Transpose trans_a = NO_TRANS, const Transpose trans_b = NO_TRANS);
+
+// Appends every record to a named dataset in two forms. NAME.jsonl gets one JSON object
+// per line. NAME.bin gets the numeric columns as one fixed-width row per record, after a
+// header that names them once per open():
+//
+//		"OSGS", version, bytes of the header, columns		(uint32 each)
+//		device name, driver, then each column name			(NUL terminated)
+//		NULs up to a multiple of 8 bytes with the "OSGE" after them
+//
+//		"OSGR", columns										(uint32 each)
+//		one double per column
+//
+// Both files are flushed after every record, so a crash of the process loses nothing
+// appended before it; they are synced to disk at most once a second, on flush() and on
+// close(). A crash can only tear the last line, header or row: one that runs past the
+// end of the file. Readers skip it, and open() cuts it off before appending. Anything
+// else (another version, or corruption mid-file) makes open() refuse the dataset and
+// leave it as it is; readers keep the rows before it.
+class ResultsWriter {
+public:
+	ResultsWriter();
+	~ResultsWriter();
+
+	bool open(const std::string& name, const DeviceInfo* device);
+	bool is_open() const 	{ return json != NULL; }
+	bool append(const ResultRecord& record);
+	bool flush();			// sync both files to disk now
+	void close();
+
+	int rows() const 		{ return appended; }
+	const std::string& dataset() const 	{ return name; }
+
+private:
+	ResultsWriter(const ResultsWriter&);
+	ResultsWriter& operator=(const ResultsWriter&);
+
+	std::string 		name;
+	const DeviceInfo* 	device;
+	FILE* 				json;
+	FILE* 				binary;
+	bool 				described;	// the columns are named since open()
+	int 				appended;
+	time_t 				synced;		// second of the last sync to disk
+	std::vector<std::string> 	columns;
+};
+
+// Model inputs (config_feature_names()) and times of every complete row of a NAME.bin
+// file, as load_dataset() returns them; failed and aborted records are skipped. Rows
+// written before a column was added read it as 0.
+bool load_results(const std::string& path, std::vector<Sample>& X, std::vector<double>& y,
+				  std::vector<std::string>& columns);
+
+#endif
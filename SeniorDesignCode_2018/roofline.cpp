@@ -0,0 +1,157 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: roofline.cpp
+//	Function(s): sgemm_gflops(), sgemm_bandwidth(), sgemm_intensity(),
+//				 calibrate_device(), roofline_gflops(), print_roofline_report()
+//
+//	Purpose: 	Throughput metrics and a roofline model of the device. Milliseconds
+//				cannot be compared across matrix sizes, so every measurement is also
+//				reported in GFLOP/s and effective GB/s. The device peak is measured with
+//				two micro-benchmarks (a multiply-add chain and a streaming copy) and
+//				related to the compute units and clock clPrintDevInfo() lists.
+//
+/****************************************************************************************/
+
+#include "roofline.hpp"
+#include "benchmark.hpp"
+
+#include <cstdio>
+#include <algorithm>
+
+// Work-items and rounds of the calibration kernels
+static const int CAL_ITEMS 	= 1 << 16;
+static const int CAL_ITERS 	= 1024;
+static const int COPY_ITEMS = 1 << 20;	// float4 per work-item, 16 MB per buffer
+
+static const char* variant_names[3] = {"global memory", "local memory", "register tiles"};
+
+double sgemm_gflops(const int M, const int N, const int K, const double ms)
+{
+	if (ms <= 0)
+		return 0.0;
+	return 2.0 * M * N * K / (ms * 1e6);
+}
+
+double sgemm_bandwidth(const int M, const int N, const int K, const double ms)
+{
+	if (ms <= 0)
+		return 0.0;
+	double bytes = sizeof(float) * ((double) M * K + (double) K * N + (double) M * N);
+	return bytes / (ms * 1e6);
+}
+
+double sgemm_intensity(const int M, const int N, const int K)
+{
+	double bytes = sizeof(float) * ((double) M * K + (double) K * N + (double) M * N);
+	return 2.0 * M * N * K / bytes;
+}
+
+bool calibrate_device(Session& session, DevicePeak& peak)
+{
+	peak.compute_units = 0;
+	peak.clock_mhz = 0;
+	peak.gflops = 0.0;
+	peak.bandwidth = 0.0;
+	peak.flops_per_cycle = 0.0;
+	if (!session.ready())
+		return false;
+
+	cl_uint compute_units = 0, clock_frequency = 0;
+	clGetDeviceInfo(session.device(), CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(compute_units), &compute_units, NULL);
+	clGetDeviceInfo(session.device(), CL_DEVICE_MAX_CLOCK_FREQUENCY, sizeof(clock_frequency), &clock_frequency, NULL);
+	peak.compute_units = compute_units;
+	peak.clock_mhz = clock_frequency;
+
+	char options[64];
+	sprintf(options, "-D CALIBRATE=1 -D CAL_ITERS=%d", CAL_ITERS);
+	cl_kernel flops_kernel = session.get_kernel(options, "peak_flops");
+	cl_kernel copy_kernel = session.get_kernel(options, "peak_copy");
+	if (!flops_kernel || !copy_kernel)
+		return false;
+
+	cl_int err;
+	size_t copy_bytes = sizeof(float) * 4 * (size_t) COPY_ITEMS;
+	cl_mem d_out = clCreateBuffer(session.context(), CL_MEM_WRITE_ONLY, sizeof(float) * 4 * CAL_ITEMS, NULL, &err);
+	cl_mem d_src = clCreateBuffer(session.context(), CL_MEM_READ_ONLY, copy_bytes, NULL, &err);
+	cl_mem d_dst = clCreateBuffer(session.context(), CL_MEM_WRITE_ONLY, copy_bytes, NULL, &err);
+	if (!d_out || !d_src || !d_dst){
+		std::cerr << "	Error. Failed to allocate calibration buffers!" << std::endl;
+		if (d_out) clReleaseMemObject(d_out);
+		if (d_src) clReleaseMemObject(d_src);
+		if (d_dst) clReleaseMemObject(d_dst);
+		return false;
+	}
+
+	BenchmarkOptions bench = default_benchmark_options();
+	BenchmarkStats stats;
+	float seed = 1.0f;
+
+	// The fastest run is the closest to the peak
+	size_t items = CAL_ITEMS;
+	err  = clSetKernelArg(flops_kernel, 0, sizeof(cl_mem), (void *)&d_out);
+	err |= clSetKernelArg(flops_kernel, 1, sizeof(float), (void *)&seed);
+	if (err == CL_SUCCESS)
+		err = benchmark_kernel(session.queue(), flops_kernel, 1, &items, NULL, bench, stats);
+	if (err == CL_SUCCESS)
+		peak.gflops = 32.0 * CAL_ITERS * CAL_ITEMS / (stats.min * 1e6);
+
+	items = COPY_ITEMS;
+	if (err == CL_SUCCESS){
+		err  = clSetKernelArg(copy_kernel, 0, sizeof(cl_mem), (void *)&d_dst);
+		err |= clSetKernelArg(copy_kernel, 1, sizeof(cl_mem), (void *)&d_src);
+	}
+	if (err == CL_SUCCESS)
+		err = benchmark_kernel(session.queue(), copy_kernel, 1, &items, NULL, bench, stats);
+	if (err == CL_SUCCESS)
+		peak.bandwidth = 2.0 * copy_bytes / (stats.min * 1e6);
+
+	clReleaseMemObject(d_out);
+	clReleaseMemObject(d_src);
+	clReleaseMemObject(d_dst);
+
+	if (err != CL_SUCCESS)
+		return false;
+	if (peak.compute_units > 0 && peak.clock_mhz > 0)
+		peak.flops_per_cycle = peak.gflops * 1000.0 / ((double) peak.compute_units * peak.clock_mhz);
+	return true;
+}
+
+double roofline_gflops(const DevicePeak& peak, const int M, const int N, const int K)
+{
+	return std::min(peak.gflops, sgemm_intensity(M, N, K) * peak.bandwidth);
+}
+
+void print_roofline_report(const DevicePeak& peak, const int M, const int N, const int K,
+						   const double best_ms[3])
+{
+	double bound = roofline_gflops(peak, M, N, K);
+
+	printf("\nRoofline report for %d x %d x %d\n==========================\n", M, N, K);
+	printf("	Device: %d compute units at %d MHz\n", peak.compute_units, peak.clock_mhz);
+	printf("	Measured peak: %.2f GFLOP/s (%.1f flops/cycle/unit), %.2f GB/s\n",
+		   peak.gflops, peak.flops_per_cycle, peak.bandwidth);
+	printf("	Arithmetic intensity: %.2f flops/byte, roofline bound %.2f GFLOP/s (%s bound)\n",
+		   sgemm_intensity(M, N, K), bound, bound < peak.gflops ? "memory" : "compute");
+
+	for (int v = 0; v < 3; v++){
+		if (best_ms[v] < 0)
+			continue;
+		double gflops = sgemm_gflops(M, N, K, best_ms[v]);
+		printf("	LOCAL_MEM=%d (%s): %.3f ms, %.2f GFLOP/s, %.2f GB/s, %.1f%% of peak, %.1f%% of roofline\n",
+			   v, variant_names[v], best_ms[v], gflops, sgemm_bandwidth(M, N, K, best_ms[v]),
+			   peak.gflops > 0 ? 100.0 * gflops / peak.gflops : 0.0,
+			   bound > 0 ? 100.0 * gflops / bound : 0.0);
+	}
+}
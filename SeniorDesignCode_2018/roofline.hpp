@@ -0,0 +1,52 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: roofline.hpp
+//	Purpose of File: Header File for roofline.cpp
+//
+/****************************************************************************************/
+
+#ifndef ROOFLINE
+#define ROOFLINE
+
+#include "session.hpp"
+
+// Peak compute rate and bandwidth of the session's device
+struct DevicePeak {
+	int 	compute_units;		// CL_DEVICE_MAX_COMPUTE_UNITS
+	int 	clock_mhz;			// CL_DEVICE_MAX_CLOCK_FREQUENCY
+	double 	gflops;				// measured by the peak_flops micro-benchmark
+	double 	bandwidth;			// GB/s, measured by the peak_copy micro-benchmark
+	double 	flops_per_cycle;	// per compute unit, gflops / (units * clock)
+};
+
+// Achieved rates of one C (M x N) = A (M x K) * B (K x N) that took ms milliseconds
+double sgemm_gflops(const int M, const int N, const int K, const double ms);
+double sgemm_bandwidth(const int M, const int N, const int K, const double ms);
+
+// Flops per byte of compulsory traffic: A and B read once, C written once
+double sgemm_intensity(const int M, const int N, const int K);
+
+// Time the calibration kernels of sgemm.cl on the session's device
+bool calibrate_device(Session& session, DevicePeak& peak);
+
+// Roofline bound of M x N x K: min(peak compute, intensity * peak bandwidth)
+double roofline_gflops(const DevicePeak& peak, const int M, const int N, const int K);
+
+// Percent of peak and of the roofline bound reached by the fastest time of each
+// kernel variant (LOCAL_MEM 0, 1 and 2); variants with best_ms < 0 are skipped
+void print_roofline_report(const DevicePeak& peak, const int M, const int N, const int K,
+						   const double best_ms[3]);
+
+#endif
@@ -0,0 +1,344 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: sampler.cpp
+//	Function(s): PipelinedSampler::run(), PipelinedSampler::print_report()
+//
+//	Purpose: 	Pipelined sample generation. host() runs one sample at a time: seed,
+//				upload, launch, wait, read back, verify, and only then the next one,
+//				so the device idles through all of the host work. Here the matrices
+//				are seeded once per shape, uploads and readbacks go through their own
+//				queue and are chained to the kernels with events, and the check of
+//				a result runs on a host thread while the next samples are already on
+//				the device.
+//				Every sample still reports its own phases: the transfer events are
+//				kept until the sample is collected.
+//
+/****************************************************************************************/
+
+#include "sampler.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+PipelinedSampler::PipelinedSampler(Session& session, const int M, const int N, const int K,
+								   const BenchmarkOptions& bench, const VerifyOptions& verify)
+	: session(session), M(M), N(N), K(K), bench(bench), verify(verify),
+	  transfer(NULL), abort_factor(0.0), best_ms(-1), aborted(0),
+	  samples(0), wall_ms(0.0), kernel_ms(0.0)
+{
+	for (int s = 0; s < 2; s++){
+		slots[s].index = -1;
+		slots[s].kernel = NULL;
+		slots[s].d_A = slots[s].d_B = slots[s].d_C = NULL;
+		slots[s].pad_A = slots[s].pad_B = NULL;
+		slots[s].read = NULL;
+		slots[s].cutoff = 0.0;
+		slots[s].failed = false;
+	}
+
+	if (!session.ready() || M <= 0 || N <= 0 || K <= 0)
+		return;
+
+	// The same inputs serve every sample of the shape
+	A.resize((size_t) M * K);
+	B.resize((size_t) K * N);
+	seedMatrix(A.data(), A.size());
+	seedMatrix(B.data(), B.size());
+
+	cl_int err;
+	transfer = clCreateCommandQueue(session.context(), session.device(), CL_QUEUE_PROFILING_ENABLE, &err);
+	if (err != CL_SUCCESS){
+		std::cerr << "	Error. Failed to create a transfer queue!" << err << std::endl;
+		transfer = NULL;
+	}
+}
+
+PipelinedSampler::~PipelinedSampler()
+{
+	clFinish(session.queue());
+	if (transfer)
+		clFinish(transfer);
+	for (int s = 0; s < 2; s++){
+		release_events(slots[s]);
+		release_buffers(slots[s]);
+	}
+	if (transfer)
+		clReleaseCommandQueue(transfer);
+}
+
+// Hand the buffers of a finished sample back to the pool
+void PipelinedSampler::release_buffers(Slot& slot)
+{
+	BufferPool& pool = session.pool();
+	if (slot.d_A) pool.release(slot.d_A);
+	if (slot.d_B) pool.release(slot.d_B);
+	if (slot.d_C) pool.release(slot.d_C);
+	if (slot.pad_A) pool.release_host(slot.pad_A);
+	if (slot.pad_B) pool.release_host(slot.pad_B);
+	slot.d_A = slot.d_B = slot.d_C = NULL;
+	slot.pad_A = slot.pad_B = NULL;
+}
+
+void PipelinedSampler::release_events(Slot& slot)
+{
+	for (size_t i = 0; i < slot.launches.size(); i++)
+		clReleaseEvent(slot.launches[i]);
+	slot.launches.clear();
+	for (size_t i = 0; i < slot.uploads.size(); i++)
+		clReleaseEvent(slot.uploads[i]);
+	slot.uploads.clear();
+	if (slot.read)
+		clReleaseEvent(slot.read);
+	slot.read = NULL;
+}
+
+// Upload, launch and read back one sample without waiting for any of it
+void PipelinedSampler::submit(Slot& slot, const int index, const KernelConfig& config)
+{
+	slot.index = index;
+	slot.config = config;
+	slot.failed = true;
+
+	if (!check_config(config))
+		return;
+	if (session.info() && !config_fits(config, *session.info(), 1))
+		return;
+
+	// Building a new variant is host work that overlaps the kernels already queued
+	slot.phases = no_phases();
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	slot.kernel = session.get_kernel(build_options(config), "sgemm");
+	if (!slot.kernel)
+		return;
+	slot.phases.build = elapsed_ms(start);
+	start = std::chrono::steady_clock::now();
+
+	padded_size(config, M, N, K, slot.run_M, slot.run_N, slot.run_K);
+	slot.C.resize((size_t) slot.run_M * slot.run_N);
+	size_t bytes_A = sizeof(float) * slot.run_M * slot.run_K;
+	size_t bytes_B = sizeof(float) * slot.run_K * slot.run_N;
+	size_t bytes_C = sizeof(float) * slot.C.size();
+
+	BufferPool& pool = session.pool();
+	slot.d_A = pool.acquire(bytes_A);
+	slot.d_B = pool.acquire(bytes_B);
+	slot.d_C = pool.acquire(bytes_C);
+	if (!slot.d_A || !slot.d_B || !slot.d_C)
+		return;
+
+	// Padded inputs are staged in pinned memory that lives until the upload is done
+	const float* src_A = A.data();
+	const float* src_B = B.data();
+	if (slot.run_M != M || slot.run_K != K){
+		if (!(slot.pad_A = pool.acquire_host(bytes_A)))
+			return;
+		copy_padded(A.data(), M, K, K, slot.pad_A, slot.run_M, slot.run_K);
+		src_A = slot.pad_A;
+	}
+	if (slot.run_K != K || slot.run_N != N){
+		if (!(slot.pad_B = pool.acquire_host(bytes_B)))
+			return;
+		copy_padded(B.data(), K, N, N, slot.pad_B, slot.run_K, slot.run_N);
+		src_B = slot.pad_B;
+	}
+
+	cl_int err;
+	cl_event written[2] = {NULL, NULL};
+	err  = clEnqueueWriteBuffer(transfer, slot.d_A, CL_FALSE, 0, bytes_A, src_A, 0, NULL, &written[0]);
+	err |= clEnqueueWriteBuffer(transfer, slot.d_B, CL_FALSE, 0, bytes_B, src_B, 0, NULL, &written[1]);
+	if (err != CL_SUCCESS){
+		std::cerr << "	Error. Failed to write the input arrays!" << err << std::endl;
+		if (written[0]) clReleaseEvent(written[0]);
+		if (written[1]) clReleaseEvent(written[1]);
+		return;
+	}
+
+	// Arguments are captured at enqueue time, so the kernel object can be reused by
+	// the next sample before this one has run
+	err = set_sgemm_args(slot.kernel, slot.d_C, slot.d_A, slot.d_B,
+						 slot.run_M, slot.run_N, slot.run_K, slot.run_K, slot.run_N, slot.run_N);
+	launch_size(config, slot.run_M, slot.run_N, slot.local, slot.global);
+	if (err != CL_SUCCESS){
+		std::cerr << "	Error. Failed to set kernel arguments!" << err << std::endl;
+	}
+	else {
+		// Behind a cutoff a single launch is queued: a hopeless sample stops there, the
+		// others take their timed launches when they are collected
+		slot.cutoff = cutoff();
+		int queued = slot.cutoff > 0 ? 1 : bench.warmup + std::max(1, bench.min_reps);
+		err = enqueue_launches(session.queue(), slot.kernel, 2, slot.global, slot.local,
+							   queued, 2, written, slot.launches);
+	}
+	slot.uploads.push_back(written[0]);
+	slot.uploads.push_back(written[1]);
+	if (err != CL_SUCCESS || slot.launches.empty())
+		return;
+
+	err = clEnqueueReadBuffer(transfer, slot.d_C, CL_FALSE, 0, bytes_C, slot.C.data(),
+							  1, &slot.launches.back(), &slot.read);
+	if (err != CL_SUCCESS){
+		std::cerr << "	Error. Failed to read output array!" << err << std::endl;
+		slot.read = NULL;
+		return;
+	}
+
+	clFlush(session.queue());
+	clFlush(transfer);
+	slot.phases.host = elapsed_ms(start);
+	slot.failed = false;
+}
+
+// Wait for the readback of a sample, finish its timings and start checking it
+void PipelinedSampler::collect(Slot& slot, Pending& pending)
+{
+	pending.sample.index = slot.index;
+	pending.sample.config = slot.config;
+	pending.sample.time = -1;
+	pending.sample.stats = summarize(std::vector<double>(), 0);
+	pending.sample.verified.passed = false;
+	pending.sample.verified.max_error = 0.0;
+	pending.sample.verified.checked = 0;
+	pending.sample.verified.ms = 0.0;
+
+	std::vector<double> times;
+	if (!slot.failed && clWaitForEvents(1, &slot.read) == CL_SUCCESS &&
+		event_times(slot.launches, times) == CL_SUCCESS){
+		for (size_t i = 0; i < times.size(); i++)
+			kernel_ms += times[i];
+
+		// The queued launches cover min_reps; noisy samples take more, one at a time.
+		// Behind a cutoff the one queued launch was the warm-up.
+		BenchmarkOptions run = bench;
+		run.abort_ms = slot.cutoff;
+		cl_int err = CL_SUCCESS;
+		if (slot.cutoff > 0 && *std::min_element(times.begin(), times.end()) > slot.cutoff){
+			pending.sample.stats = summarize(times, 0);
+			pending.sample.stats.aborted = true;
+		}
+		else {
+			size_t warmup = slot.cutoff > 0 ? times.size() : std::min((size_t) bench.warmup, times.size());
+			std::vector<double> timed(times.begin() + warmup, times.end());
+			size_t queued = timed.size();
+			err = set_sgemm_args(slot.kernel, slot.d_C, slot.d_A, slot.d_B,
+								 slot.run_M, slot.run_N, slot.run_K, slot.run_K, slot.run_N, slot.run_N);
+			if (err == CL_SUCCESS)
+				err = benchmark_more(session.queue(), slot.kernel, 2, slot.global, slot.local,
+									 run, timed, pending.sample.stats);
+			for (size_t i = queued; i < timed.size(); i++)
+				kernel_ms += timed[i];
+		}
+		slot.failed = err != CL_SUCCESS;
+
+		// The transfers ran on their own queue, each profiled by its event
+		std::vector<double> read_ms;
+		pending.sample.stats.phases = slot.phases;
+		pending.sample.stats.phases.upload = drain_events(slot.uploads);
+		if (event_times(std::vector<cl_event>(1, slot.read), read_ms) == CL_SUCCESS)
+			pending.sample.stats.phases.download = read_ms[0];
+		pending.sample.stats.phases.kernel = pending.sample.stats.median;
+	}
+	else {
+		// Nothing of a failed sample may still be running when its buffers are reused
+		clFinish(session.queue());
+		clFinish(transfer);
+		slot.failed = true;
+	}
+	release_events(slot);
+	release_buffers(slot);
+
+	if (!slot.failed && pending.sample.stats.aborted){
+		// Already too slow to matter; its result is not checked
+		aborted++;
+		pending.sample.verified.passed = true;
+	}
+	else if (!slot.failed){
+		pending.C.swap(slot.C);
+		int ldc = slot.run_N;
+		const float* C = pending.C.data();
+		pending.check = std::async(std::launch::async, [this, C, ldc]() {
+			return verify_sgemm(verify, M, N, K, A.data(), K, B.data(), N, C, ldc);
+		});
+	}
+	slot.index = -1;
+}
+
+// Hand a checked sample to the caller
+void PipelinedSampler::deliver(Pending& pending, const std::function<void(const PipelineSample&)>& done)
+{
+	if (pending.sample.index < 0)
+		return;
+
+	if (pending.check.valid()){
+		pending.sample.verified = pending.check.get();
+		if (pending.sample.verified.passed){
+			pending.sample.time = pending.sample.stats.median;
+			if (best_ms < 0 || pending.sample.time < best_ms)
+				best_ms = pending.sample.time;
+		}
+	}
+	else if (pending.sample.stats.aborted){
+		pending.sample.time = pending.sample.stats.median;
+	}
+	samples++;
+	done(pending.sample);
+	pending.sample.index = -1;
+}
+
+// Kernel time above which a sample is stopped, 0 while there is no cutoff
+double PipelinedSampler::cutoff() const
+{
+	return abort_factor > 0 && best_ms > 0 ? abort_factor * best_ms : 0.0;
+}
+
+int PipelinedSampler::run(const std::vector<KernelConfig>& configs,
+						  const std::function<void(const PipelineSample&)>& done)
+{
+	if (!ready())
+		return -1;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int count = configs.size();
+
+	// Sample i goes to the device before sample i-1 is collected, so the device always
+	// has the next kernels queued while the host finishes the previous sample
+	Pending pending;
+	pending.sample.index = -1;
+	for (int i = 0; i < count; i++){
+		submit(slots[i % 2], i, configs[i]);
+		if (i > 0){
+			deliver(pending, done);
+			collect(slots[(i - 1) % 2], pending);
+		}
+	}
+	if (count > 0){
+		deliver(pending, done);
+		collect(slots[(count - 1) % 2], pending);
+		deliver(pending, done);
+	}
+
+	wall_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return count;
+}
+
+void PipelinedSampler::print_report() const
+{
+	if (wall_ms <= 0)
+		return;
+	printf("Pipelined %d samples in %.1f ms (%.2f samples/s), device busy %.0f%% of the time\n",
+		   samples, wall_ms, 1000.0 * samples / wall_ms, 100.0 * kernel_ms / wall_ms);
+	if (aborted > 0){
+		printf("	%d samples stopped early, over %.1f times the fastest\n", aborted, abort_factor);
+	}
+}
@@ -0,0 +1,117 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: sampler.hpp
+//	Purpose of File: Header File for sampler.cpp
+//
+/****************************************************************************************/
+
+#ifndef SAMPLER
+#define SAMPLER
+
+#include <functional>
+#include <future>
+#include <vector>
+
+#include "host.hpp"
+#include "benchmark.hpp"
+#include "verify.hpp"
+
+// One finished sample of a pipelined sweep
+struct PipelineSample {
+	int 			index;		// position in the list of configurations
+	KernelConfig 	config;
+	double 			time;		// median kernel time in ms, -1 if it failed to run or verify
+	BenchmarkStats 	stats;
+	VerifyResult 	verified;
+};
+
+// Times a list of configurations on one shape with the host work overlapped with the
+// device. While the device runs sample i, sample i+1 is compiled and uploaded on a
+// second queue, and the result of sample i-1 is checked on a host thread. Device
+// buffers are double-buffered from the session pool, so the uploads never wait for a
+// running kernel and a sweep allocates nothing after its first two samples.
+class PipelinedSampler {
+public:
+	PipelinedSampler(Session& session, const int M, const int N, const int K,
+					 const BenchmarkOptions& bench, const VerifyOptions& verify);
+	~PipelinedSampler();
+
+	bool ready() const 	{ return transfer != NULL; }
+
+	// Stop timing a sample once it is factor times slower than the fastest one so far,
+	// and keep its partial time unchecked; 0 (the default) times every sample in full
+	void set_abort_factor(const double factor) 	{ abort_factor = factor; }
+
+	// Run every configuration; done is called once per sample, in order
+	int run(const std::vector<KernelConfig>& configs,
+			const std::function<void(const PipelineSample&)>& done);
+
+	// Samples per second and the share of the wall time the device spent in kernels
+	void print_report() const;
+
+private:
+	PipelinedSampler(const PipelinedSampler&);
+	PipelinedSampler& operator=(const PipelinedSampler&);
+
+	// Device buffers and host state of one sample in flight
+	struct Slot {
+		int 				index;		// sample in the slot, -1 when it is free
+		KernelConfig 		config;
+		cl_kernel 			kernel;
+		int 				run_M, run_N, run_K;
+		size_t 				local[2], global[2];
+		float* 				pad_A;		// pinned staging of padded inputs, NULL if unpadded
+		float* 				pad_B;
+		std::vector<float> 	C;
+		cl_mem 				d_A, d_B, d_C;	// from the session pool while the sample runs
+		std::vector<cl_event> launches;
+		std::vector<cl_event> uploads;
+		cl_event 			read;
+		PhaseTimes 			phases;		// build and host work of submit()
+		double 				cutoff;		// abort_ms of the sample when it was submitted
+		bool 				failed;
+	};
+
+	// A sample whose result is being checked on the host thread
+	struct Pending {
+		PipelineSample 				sample;
+		std::vector<float> 			C;		// result read back, run_M x run_N
+		std::future<VerifyResult> 	check;
+	};
+
+	void release_buffers(Slot& slot);
+	void submit(Slot& slot, const int index, const KernelConfig& config);
+	void collect(Slot& slot, Pending& pending);
+	void release_events(Slot& slot);
+	void deliver(Pending& pending, const std::function<void(const PipelineSample&)>& done);
+	double cutoff() const;
+
+	Session& 			session;
+	int 				M, N, K;
+	BenchmarkOptions 	bench;
+	VerifyOptions 		verify;
+	std::vector<float> 	A, B;
+	cl_command_queue 	transfer;	// uploads and readbacks; kernels run on the session queue
+	Slot 				slots[2];
+
+	double 				abort_factor;
+	double 				best_ms;		// fastest checked sample so far
+	int 				aborted;
+
+	int 				samples;
+	double 				wall_ms, kernel_ms;
+};
+
+#endif
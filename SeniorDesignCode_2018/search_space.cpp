@@ -0,0 +1,451 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: search_space.cpp
+//	Function(s): SearchSpace::load(), SearchSpace::add(), SearchSpace::sample(),
+//				 SearchSpace::mutate(), default_search_space(), parse_sampler()
+//
+//	Purpose: 	Declarative search spaces. The parameter sets used to be arrays inside
+//				generate_samples() with one shape per run; a space is now read from a
+//				file or from command-line definitions, with integer ranges, powers of
+//				two, lists of values and parameters that only exist for some values
+//				of another one. It is sampled exhaustively, uniformly at random or as
+//				a Latin hypercube, and every point is checked against the kernel and
+//				the device limits before anything is launched.
+//
+/****************************************************************************************/
+
+#include "search_space.hpp"
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+
+// Parameters a space can define, in the order of the -D options of sgemm.cl
+static const char* param_names[] = {"LOCAL_MEM", "BLOCK_SIZE", "TSM", "TSN", "TSK",
+									"WPTM", "WPTN", "VECTOR_WIDTH", "EDGE_GUARD"};
+static const int param_name_count = sizeof(param_names)/sizeof(param_names[0]);
+
+static bool parse_int(const std::string& text, int& value)
+{
+	if (text.empty())
+		return false;
+	char* end = NULL;
+	long parsed = strtol(text.c_str(), &end, 10);
+	if (*end != '\0')
+		return false;
+	value = (int) parsed;
+	return true;
+}
+
+// "a,b,c"
+static bool parse_values(const std::string& text, std::vector<int>& values)
+{
+	values.clear();
+	std::stringstream stream(text);
+	std::string item;
+	while (std::getline(stream, item, ',')){
+		int value;
+		if (!parse_int(item, value))
+			return false;
+		values.push_back(value);
+	}
+	return !values.empty();
+}
+
+// "lo..hi" with an optional ":step"
+static bool parse_range(const std::string& text, int& lo, int& hi, int& step)
+{
+	size_t dots = text.find("..");
+	if (dots == std::string::npos)
+		return false;
+	std::string upper = text.substr(dots + 2);
+	step = 1;
+	size_t colon = upper.find(':');
+	if (colon != std::string::npos){
+		if (!parse_int(upper.substr(colon + 1), step))
+			return false;
+		upper = upper.substr(0, colon);
+	}
+	return parse_int(text.substr(0, dots), lo) && parse_int(upper, hi) && lo <= hi && step > 0;
+}
+
+bool parse_sampler(const std::string& name, SamplerKind& kind)
+{
+	if (name == "exhaustive")
+		kind = SAMPLE_EXHAUSTIVE;
+	else if (name == "random")
+		kind = SAMPLE_RANDOM;
+	else if (name == "lhs" || name == "latin")
+		kind = SAMPLE_LATIN;
+	else
+		return false;
+	return true;
+}
+
+SearchSpace::SearchSpace()
+{
+}
+
+void SearchSpace::clear()
+{
+	parameters.clear();
+	problem_shapes.clear();
+}
+
+bool SearchSpace::load(const std::string& path)
+{
+	std::ifstream file(path.c_str());
+	if (!file.is_open()){
+		std::cerr << "	Error. Could not open the search space " << path << "!" << std::endl;
+		return false;
+	}
+	std::string line;
+	int number = 0;
+	while (std::getline(file, line)){
+		number++;
+		if (!add(line)){
+			std::cerr << "	Error. Line " << number << " of " << path << " is not a valid definition!" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool SearchSpace::add(const std::string& definition)
+{
+	std::string text = definition.substr(0, definition.find('#'));
+	std::stringstream stream(text);
+	std::vector<std::string> tokens;
+	std::string token;
+	while (stream >> token)
+		tokens.push_back(token);
+	if (tokens.empty())
+		return true;
+
+	if (tokens[0] == "shape"){
+		SearchShape shape;
+		if (tokens.size() != 4 || !parse_int(tokens[1], shape.M) || !parse_int(tokens[2], shape.N) ||
+			!parse_int(tokens[3], shape.K) || shape.M <= 0 || shape.N <= 0 || shape.K <= 0){
+			std::cerr << "	Error. A shape is 'shape M N K' with positive dimensions!" << std::endl;
+			return false;
+		}
+		problem_shapes.push_back(shape);
+		return true;
+	}
+
+	if (tokens.size() != 3 && tokens.size() != 5){
+		std::cerr << "	Error. A parameter is 'NAME int|pow2|list VALUES [when NAME=V,...]'!" << std::endl;
+		return false;
+	}
+
+	SearchParam param;
+	param.name = tokens[0];
+	std::transform(param.name.begin(), param.name.end(), param.name.begin(), ::toupper);
+	if (std::find(param_names, param_names + param_name_count, param.name) == param_names + param_name_count){
+		std::cerr << "	Error. " << tokens[0] << " is not a parameter of sgemm.cl!" << std::endl;
+		return false;
+	}
+
+	int lo, hi, step;
+	if (tokens[1] == "int"){
+		param.kind = PARAM_INT;
+		if (!parse_range(tokens[2], lo, hi, step)){
+			std::cerr << "	Error. An int parameter takes lo..hi or lo..hi:step!" << std::endl;
+			return false;
+		}
+		for (int value = lo; value <= hi; value += step)
+			param.values.push_back(value);
+	}
+	else if (tokens[1] == "pow2"){
+		param.kind = PARAM_POW2;
+		if (!parse_range(tokens[2], lo, hi, step) || lo <= 0){
+			std::cerr << "	Error. A pow2 parameter takes lo..hi with positive bounds!" << std::endl;
+			return false;
+		}
+		for (long long value = 1; value <= hi; value *= 2){
+			if (value >= lo)
+				param.values.push_back((int) value);
+		}
+		if (param.values.empty()){
+			std::cerr << "	Error. There is no power of two in " << tokens[2] << "!" << std::endl;
+			return false;
+		}
+	}
+	else if (tokens[1] == "list"){
+		param.kind = PARAM_LIST;
+		if (!parse_values(tokens[2], param.values)){
+			std::cerr << "	Error. A list parameter takes comma separated integers!" << std::endl;
+			return false;
+		}
+	}
+	else {
+		std::cerr << "	Error. The kind of " << param.name << " must be int, pow2 or list!" << std::endl;
+		return false;
+	}
+
+	// A parameter keeps its place when it is redefined, e.g. by a flag after a file
+	size_t place = parameters.size();
+	for (size_t p = 0; p < parameters.size(); p++){
+		if (parameters[p].name == param.name)
+			place = p;
+	}
+
+	if (tokens.size() == 5){
+		size_t equals = tokens[4].find('=');
+		if (tokens[3] != "when" || equals == std::string::npos ||
+			!parse_values(tokens[4].substr(equals + 1), param.when_values)){
+			std::cerr << "	Error. A condition is 'when NAME=V,...'!" << std::endl;
+			return false;
+		}
+		param.when = tokens[4].substr(0, equals);
+		std::transform(param.when.begin(), param.when.end(), param.when.begin(), ::toupper);
+		bool defined = false;
+		for (size_t p = 0; p < place; p++){
+			defined = defined || parameters[p].name == param.when;
+		}
+		if (!defined){
+			std::cerr << "	Error. " << param.name << " depends on " << param.when
+					  << ", which must be defined before it!" << std::endl;
+			return false;
+		}
+	}
+
+	if (place < parameters.size())
+		parameters[place] = param;
+	else
+		parameters.push_back(param);
+	return true;
+}
+
+bool SearchSpace::add_shapes(const std::string& list)
+{
+	std::stringstream stream(list);
+	std::string item;
+	while (std::getline(stream, item, ',')){
+		std::replace(item.begin(), item.end(), 'X', 'x');
+		std::replace(item.begin(), item.end(), 'x', ' ');
+		if (!add("shape " + item))
+			return false;
+	}
+	return true;
+}
+
+bool SearchSpace::active(const std::vector<int>& point, const int param) const
+{
+	const SearchParam& p = parameters[param];
+	if (p.when.empty())
+		return true;
+	for (int w = 0; w < param; w++){
+		if (parameters[w].name != p.when)
+			continue;
+		if (point[w] < 0)
+			return false;
+		int value = parameters[w].values[point[w]];
+		return std::find(p.when_values.begin(), p.when_values.end(), value) != p.when_values.end();
+	}
+	return false;
+}
+
+// Fields the chosen variant does not read are reset, so equal kernels compare equal
+KernelConfig SearchSpace::to_config(const std::vector<int>& point) const
+{
+	KernelConfig config = make_config(0, 1);
+	for (size_t p = 0; p < parameters.size(); p++){
+		if (point[p] < 0)
+			continue;
+		int value = parameters[p].values[point[p]];
+		const std::string& name = parameters[p].name;
+		if (name == "LOCAL_MEM")			config.local_mem = value;
+		else if (name == "BLOCK_SIZE")		config.block_size = value;
+		else if (name == "TSM")				config.tsm = value;
+		else if (name == "TSN")				config.tsn = value;
+		else if (name == "TSK")				config.tsk = value;
+		else if (name == "WPTM")			config.wptm = value;
+		else if (name == "WPTN")			config.wptn = value;
+		else if (name == "VECTOR_WIDTH")	config.vector_width = value;
+		else if (name == "EDGE_GUARD")		config.edge_guard = value;
+	}
+	if (config.local_mem == 2){
+		config.block_size = 1;
+	}
+	else {
+		config.tsm = config.tsn = config.tsk = config.wptm = config.wptn = 0;
+		if (config.local_mem == 1)
+			config.vector_width = 1;
+	}
+	return config;
+}
+
+bool SearchSpace::keep(const std::vector<int>& point, std::vector<KernelConfig>& configs,
+					   std::set<std::string>& seen, const DeviceInfo* device, int& pruned) const
+{
+	KernelConfig config = to_config(point);
+	if (config.local_mem < 0 || config.local_mem > 2 || config.edge_guard < 0 || config.edge_guard > 1){
+		pruned++;
+		return false;
+	}
+	if (!seen.insert(build_options(config)).second)
+		return false;
+	if (!check_config(config, 0) || (device && !config_fits(config, *device))){
+		pruned++;
+		return false;
+	}
+	configs.push_back(config);
+	return true;
+}
+
+void SearchSpace::enumerate(std::vector<int>& point, const int param, std::vector<KernelConfig>& configs,
+							std::set<std::string>& seen, const DeviceInfo* device, int& pruned) const
+{
+	if (param == (int) parameters.size()){
+		keep(point, configs, seen, device, pruned);
+		return;
+	}
+	if (!active(point, param)){
+		point[param] = -1;
+		enumerate(point, param + 1, configs, seen, device, pruned);
+		return;
+	}
+	for (size_t v = 0; v < parameters[param].values.size(); v++){
+		point[param] = v;
+		enumerate(point, param + 1, configs, seen, device, pruned);
+	}
+}
+
+void SearchSpace::sample(const SamplerKind kind, const int count, const unsigned seed,
+						 std::vector<KernelConfig>& configs, const DeviceInfo* device,
+						 int* pruned) const
+{
+	configs.clear();
+	std::set<std::string> seen;
+	int dropped = 0;
+	int params = parameters.size();
+	std::vector<int> point(params, -1);
+	std::mt19937 rng(seed);
+
+	if (kind == SAMPLE_EXHAUSTIVE){
+		enumerate(point, 0, configs, seen, device, dropped);
+	}
+	else if (kind == SAMPLE_RANDOM){
+		// Pruned and repeated draws are replaced, up to a bound for small spaces
+		for (int tries = 0; tries < 50*count && (int) configs.size() < count; tries++){
+			for (int p = 0; p < params; p++){
+				point[p] = active(point, p) ? (int)(rng() % parameters[p].values.size()) : -1;
+			}
+			keep(point, configs, seen, device, dropped);
+		}
+	}
+	else {
+		// Each round is a Latin hypercube of the points still missing: every parameter
+		// has its values split into as many strata as points, each stratum used once and
+		// a value drawn within it. With more points than values a stratum falls inside
+		// one value, so every value is used about equally often.
+		for (int round = 0; round < 10 && (int) configs.size() < count; round++){
+			int points = count - configs.size();
+			std::vector<std::vector<int> > strata(params, std::vector<int>(points));
+			for (int p = 0; p < params; p++){
+				for (int i = 0; i < points; i++)
+					strata[p][i] = i;
+				std::shuffle(strata[p].begin(), strata[p].end(), rng);
+			}
+			for (int i = 0; i < points; i++){
+				for (int p = 0; p < params; p++){
+					if (!active(point, p)){
+						point[p] = -1;
+						continue;
+					}
+					int size = parameters[p].values.size();
+					int lo = (int)((long long) strata[p][i] * size / points);
+					int hi = (int)((long long) (strata[p][i] + 1) * size / points);
+					point[p] = hi > lo ? lo + (int)(rng() % (hi - lo)) : lo;
+				}
+				keep(point, configs, seen, device, dropped);
+			}
+		}
+	}
+
+	if (pruned)
+		*pruned = dropped;
+}
+
+void SearchSpace::fitting_shapes(std::vector<SearchShape>& fit, const DeviceInfo* device) const
+{
+	fit.clear();
+	for (size_t s = 0; s < problem_shapes.size(); s++){
+		const SearchShape& shape = problem_shapes[s];
+		if (device){
+			cl_ulong a = sizeof(float) * (cl_ulong) shape.M * shape.K;
+			cl_ulong b = sizeof(float) * (cl_ulong) shape.K * shape.N;
+			cl_ulong c = sizeof(float) * (cl_ulong) shape.M * shape.N;
+			if (std::max(a, std::max(b, c)) > device->max_alloc || a + b + c > device->global_mem){
+				printf("	Skipping %d x %d x %d, its matrices do not fit on the device\n",
+					   shape.M, shape.N, shape.K);
+				continue;
+			}
+		}
+		fit.push_back(shape);
+	}
+}
+
+void SearchSpace::random_point(std::mt19937& rng, std::vector<int>& point) const
+{
+	point.assign(parameters.size(), -1);
+	repair(point, rng);
+}
+
+void SearchSpace::mutate(std::vector<int>& point, const int param, std::mt19937& rng) const
+{
+	int size = parameters[param].values.size();
+	if (point[param] < 0 || size < 2)
+		return;
+	// Ranges and powers of two are ordered, so a step is usually a small change in time
+	if (parameters[param].kind != PARAM_LIST && rng() % 2){
+		int step = rng() % 2 ? 1 : -1;
+		point[param] = std::min(std::max(point[param] + step, 0), size - 1);
+	}
+	else {
+		point[param] = rng() % size;
+	}
+	repair(point, rng);
+}
+
+void SearchSpace::repair(std::vector<int>& point, std::mt19937& rng) const
+{
+	point.resize(parameters.size(), -1);
+	for (size_t p = 0; p < parameters.size(); p++){
+		if (!active(point, p))
+			point[p] = -1;
+		else if (point[p] < 0 || point[p] >= (int) parameters[p].values.size())
+			point[p] = rng() % parameters[p].values.size();
+	}
+}
+
+void default_search_space(SearchSpace& space)
+{
+	static const char* definitions[] = {
+		"EDGE_GUARD   list 0,1",
+		"LOCAL_MEM    list 0,1,2",
+		"BLOCK_SIZE   pow2 1..16   when LOCAL_MEM=1",
+		"TSM          pow2 16..128 when LOCAL_MEM=2",
+		"TSN          pow2 16..128 when LOCAL_MEM=2",
+		"TSK          pow2 8..32   when LOCAL_MEM=2",
+		"WPTM         pow2 1..8    when LOCAL_MEM=2",
+		"WPTN         pow2 1..8    when LOCAL_MEM=2",
+		"VECTOR_WIDTH pow2 1..8    when LOCAL_MEM=0,2",
+	};
+	for (size_t d = 0; d < sizeof(definitions)/sizeof(definitions[0]); d++){
+		space.add(definitions[d]);
+	}
+}
@@ -0,0 +1,110 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: search_space.hpp
+//	Purpose of File: Header File for search_space.cpp
+//
+/****************************************************************************************/
+
+#ifndef SEARCH_SPACE
+#define SEARCH_SPACE
+
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "host.hpp"
+
+// How the values of a parameter are listed
+enum ParamKind {
+	PARAM_INT,		// lo..hi or lo..hi:step
+	PARAM_POW2,		// every power of two in lo..hi
+	PARAM_LIST		// a,b,c
+};
+
+// One tunable parameter, named after its -D option in sgemm.cl
+struct SearchParam {
+	std::string 		name;			// LOCAL_MEM, BLOCK_SIZE, TSM, TSN, TSK, WPTM, WPTN, VECTOR_WIDTH or EDGE_GUARD
+	ParamKind 			kind;
+	std::vector<int> 	values;
+	std::string 		when;			// parameter this one depends on, empty if always active
+	std::vector<int> 	when_values;	// values of that parameter that make this one active
+};
+
+struct SearchShape {
+	int M, N, K;
+};
+
+enum SamplerKind { SAMPLE_EXHAUSTIVE, SAMPLE_RANDOM, SAMPLE_LATIN };
+
+// "exhaustive", "random" or "lhs"
+bool parse_sampler(const std::string& name, SamplerKind& kind);
+
+// Declarative description of the configurations and shapes of a sweep. A space file has
+// one definition per line, '#' starting a comment:
+//
+//		LOCAL_MEM    list 0,1,2
+//		BLOCK_SIZE   pow2 1..16   when LOCAL_MEM=1
+//		TSK          int  8..32:8 when LOCAL_MEM=2
+//		shape 1024 1024 1024
+//
+// A conditional parameter names a parameter defined before it; while inactive it keeps
+// the value make_config() gives it. Redefining a parameter replaces it in place.
+class SearchSpace {
+public:
+	SearchSpace();
+
+	bool load(const std::string& path);
+	bool add(const std::string& definition);
+	bool add_shapes(const std::string& list);	// "MxNxK,MxNxK,..."
+	void clear();
+
+	const std::vector<SearchParam>& params() const 	{ return parameters; }
+	const std::vector<SearchShape>& shapes() const 	{ return problem_shapes; }
+
+	// Every active combination in order, or count points drawn uniformly or as a Latin
+	// hypercube. Points the kernel cannot build or the device cannot launch are pruned
+	// before they are returned, and duplicates are dropped; pruned counts them.
+	void sample(const SamplerKind kind, const int count, const unsigned seed,
+				std::vector<KernelConfig>& configs, const DeviceInfo* device = NULL,
+				int* pruned = NULL) const;
+
+	// Shapes whose matrices fit in one device buffer
+	void fitting_shapes(std::vector<SearchShape>& fit, const DeviceInfo* device = NULL) const;
+
+	// Single points for the local searches of tuner.cpp. A point holds the index of the
+	// value of each parameter, -1 while the parameter is inactive. mutate() moves one
+	// parameter to a neighbouring value or redraws it; repair() draws the parameters a
+	// change made active and clears the ones it made inactive.
+	void random_point(std::mt19937& rng, std::vector<int>& point) const;
+	void mutate(std::vector<int>& point, const int param, std::mt19937& rng) const;
+	void repair(std::vector<int>& point, std::mt19937& rng) const;
+	KernelConfig to_config(const std::vector<int>& point) const;
+
+private:
+	bool active(const std::vector<int>& point, const int param) const;
+	bool keep(const std::vector<int>& point, std::vector<KernelConfig>& configs,
+			  std::set<std::string>& seen, const DeviceInfo* device, int& pruned) const;
+	void enumerate(std::vector<int>& point, const int param, std::vector<KernelConfig>& configs,
+				   std::set<std::string>& seen, const DeviceInfo* device, int& pruned) const;
+
+	std::vector<SearchParam> 	parameters;
+	std::vector<SearchShape> 	problem_shapes;
+};
+
+// The space of enumerate_configs(): every kernel variant, tile and vector width
+void default_search_space(SearchSpace& space);
+
+#endif
@@ -0,0 +1,251 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: session.cpp
+//	Function(s): Session::Session(), Session::get_kernel(), Session::get_program(),
+//				 Session::preferred_vector_width(), Session::max_work_group_size(),
+//				 opencl_devices(), default_device(), default_kernel_path()
+//
+//	Purpose: 	This file owns the OpenCL platform, device, context, command queue and
+//				buffer pool for the whole run. Programs are compiled once per set of build options
+//				and reused by every later call to host(). Compiled binaries are also
+//				kept on disk (kernel_cache.cpp) so later runs skip compilation.
+//
+/****************************************************************************************/
+
+#include "session.hpp"
+#include "host.hpp"
+#include "kernel_cache.hpp"
+
+std::vector<cl_device_id> opencl_devices(cl_device_type type)
+{
+	std::vector<cl_device_id> devices;
+
+	cl_uint platform_count = 0;
+	if (clGetPlatformIDs(0, NULL, &platform_count) != CL_SUCCESS || platform_count == 0)
+		return devices;
+	std::vector<cl_platform_id> platforms(platform_count);
+	clGetPlatformIDs(platform_count, &platforms[0], NULL);
+
+	for (cl_uint p = 0; p < platform_count; p++){
+		cl_uint count = 0;
+		if (clGetDeviceIDs(platforms[p], type, 0, NULL, &count) != CL_SUCCESS || count == 0)
+			continue;
+		std::vector<cl_device_id> found(count);
+		clGetDeviceIDs(platforms[p], type, count, &found[0], NULL);
+		devices.insert(devices.end(), found.begin(), found.end());
+	}
+	return devices;
+}
+
+cl_device_id default_device()
+{
+	std::vector<cl_device_id> devices = opencl_devices();
+	if (devices.empty())
+	{
+		std::cerr << "	Error: No OpenCL device found!\n";
+		return NULL;
+	}
+
+	// OCLSGEMM_DEVICE picks a device by its position in opencl_devices()
+	const char* choice = getenv("OCLSGEMM_DEVICE");
+	if (choice && choice[0] != '\0')
+	{
+		int index = atoi(choice);
+		if (index >= 0 && index < (int) devices.size())
+			return devices[index];
+		std::cerr << "	Error. OCLSGEMM_DEVICE=" << choice << " is not one of the "
+				  << devices.size() << " devices, using the default!\n";
+	}
+
+	// The first GPU, or whatever device there is
+	std::vector<cl_device_id> gpus = opencl_devices(CL_DEVICE_TYPE_GPU);
+	return gpus.empty() ? devices[0] : gpus[0];
+}
+
+std::string default_kernel_path()
+{
+	const char* path = getenv("OCLSGEMM_KERNEL");
+	if (path && path[0] != '\0')
+		return path;
+	return "sgemm.cl";
+}
+
+Session::Session(const char* kernel_path, const char* cache_dir)
+	: is_ready(false), builds(0), cache_hits(0),
+	  cache_dir(cache_dir ? cache_dir : cache_directory()),
+	  device_id(NULL), device_info(NULL), ctx(NULL), cmd_queue(NULL), buffer_pool(NULL)
+{
+	open(default_device(), kernel_path);
+}
+
+Session::Session(cl_device_id device, const char* kernel_path, const char* cache_dir)
+	: is_ready(false), builds(0), cache_hits(0),
+	  cache_dir(cache_dir ? cache_dir : cache_directory()),
+	  device_id(NULL), device_info(NULL), ctx(NULL), cmd_queue(NULL), buffer_pool(NULL)
+{
+	open(device, kernel_path);
+}
+
+void Session::open(cl_device_id device, const char* kernel_path)
+{
+	cl_int err;
+
+	if (!device)
+	{
+		std::cerr << "	Error: Failed to create a device group!\n";
+		return;
+	}
+	device_id = device;
+	device_info = find_device(device);
+
+	// Create a compute context
+	ctx = clCreateContext(0, 1, &device_id, NULL, NULL, &err);
+	if (!ctx)
+	{
+		std::cerr << "	Error. Failed to create a compute context!\n";
+		return;
+	}
+
+	// Create a command queue
+	cmd_queue = clCreateCommandQueue(ctx, device_id, CL_QUEUE_PROFILING_ENABLE, &err);
+	if (!cmd_queue)
+	{
+		std::cerr << "	Error. Failed to create a command queue!\n";
+		return;
+	}
+	
+	// Buffers outlive the samples; a device sharing host memory maps them instead of copying
+	buffer_pool = new BufferPool(ctx, cmd_queue, device_info && device_info->unified_memory);
+
+	// Read the kernel source once for every program built in this session
+	std::string path = kernel_path ? kernel_path : default_kernel_path();
+	char *KernelSource;
+	if (LoadOpenCLKernel(path.c_str(), &KernelSource) < 0L)
+	{
+		perror(("	File read failed: " + path).c_str());
+		return;
+	}
+	source = KernelSource;
+	free(KernelSource);
+
+	is_ready = true;
+}
+
+Session::~Session()
+{
+	std::map<std::string, cl_kernel>::iterator k;
+	for (k = kernels.begin(); k != kernels.end(); ++k)
+		clReleaseKernel(k->second);
+
+	std::map<std::string, cl_program>::iterator p;
+	for (p = programs.begin(); p != programs.end(); ++p)
+		clReleaseProgram(p->second);
+
+	delete buffer_pool;
+	if (cmd_queue)
+		clReleaseCommandQueue(cmd_queue);
+	if (ctx)
+		clReleaseContext(ctx);
+}
+
+int Session::preferred_vector_width() const
+{
+	int width = device_info ? device_info->vector_width : 1;
+
+	// The kernel supports float, float2, float4 and float8
+	if (width >= 8) return 8;
+	if (width >= 4) return 4;
+	if (width >= 2) return 2;
+	return 1;
+}
+
+int Session::max_work_group_size() const
+{
+	return device_info ? (int) device_info->max_work_group : 0;
+}
+
+cl_program Session::get_program(const std::string& options)
+{
+	std::map<std::string, cl_program>::iterator found = programs.find(options);
+	if (found != programs.end())
+		return found->second;
+
+	// Reuse a binary compiled by an earlier run when one is cached on disk
+	std::string key = cache_key(source, options, device_id);
+	cl_program program = cache_dir.empty() ? NULL
+						 : load_cached_program(ctx, device_id, cache_dir, key, options);
+	if (program)
+	{
+		cache_hits++;
+		programs[options] = program;
+		return program;
+	}
+
+	cl_int err;
+	const char* src = source.c_str();
+	program = clCreateProgramWithSource(ctx, 1, &src, NULL, &err);
+	if (!program)
+	{
+		std::cerr << "	Error. Failed to create compute program!\n";
+		return NULL;
+	}
+
+	// Build the program executable with options
+	err = clBuildProgram(program, 0, NULL, options.c_str(), NULL, NULL);
+	if (err != CL_SUCCESS)
+	{
+		size_t len;
+		char buffer[2048];
+		std::cerr << "	Error. Failed to build program executable!\n";
+		clGetProgramBuildInfo(program, device_id, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, &len);
+		std::cout << buffer;
+		clReleaseProgram(program);
+		return NULL;
+	}
+
+	if (!cache_dir.empty() && !store_cached_program(program, cache_dir, key))
+		std::cerr << "	Warning. Could not write kernel binary to " << cache_dir << std::endl;
+
+	builds++;
+	programs[options] = program;
+	return program;
+}
+
+cl_kernel Session::get_kernel(const std::string& options, const char* kernel_name)
+{
+	if (!is_ready)
+		return NULL;
+
+	std::string key = options + "|" + kernel_name;
+	std::map<std::string, cl_kernel>::iterator found = kernels.find(key);
+	if (found != kernels.end())
+		return found->second;
+
+	cl_program program = get_program(options);
+	if (!program)
+		return NULL;
+
+	// Create the compute kernel in the program we wish to run
+	cl_int err;
+	cl_kernel kernel = clCreateKernel(program, kernel_name, &err);
+	if (!kernel || err != CL_SUCCESS)
+	{
+		std::cerr << "	Error. Failed to create compute kernel!\n";
+		return NULL;
+	}
+
+	kernels[key] = kernel;
+	return kernel;
+}
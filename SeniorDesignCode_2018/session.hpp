@@ -0,0 +1,104 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: session.hpp
+//	Purpose of File: Header File for session.cpp
+//
+/****************************************************************************************/
+
+#ifndef SESSION
+#define SESSION
+
+#include <iostream>
+#include <string>
+#include <map>
+#include <vector>
+
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+#include "devInfo.hpp"
+#include "buffer_pool.hpp"
+
+// Every device of every platform of the given type
+std::vector<cl_device_id> opencl_devices(cl_device_type type = CL_DEVICE_TYPE_ALL);
+
+// Device of the default Session: OCLSGEMM_DEVICE (an index into opencl_devices()),
+// otherwise the first GPU, otherwise the first device of any type
+cl_device_id default_device();
+
+// Kernel source sessions build from: OCLSGEMM_KERNEL, otherwise ./sgemm.cl
+std::string default_kernel_path();
+
+// Long-lived OpenCL state shared by every sample of a run. The platform, device,
+// context and queue are created once, and compiled programs are kept by their
+// build options so each "-D LOCAL_MEM/-D BLOCK_SIZE" variant is built only once.
+class Session {
+public:
+	// kernel_path NULL reads default_kernel_path(); cache_dir NULL keeps compiled
+	// binaries in cache_directory(), "" keeps them in memory only
+	Session(const char* kernel_path = NULL, const char* cache_dir = NULL);
+	Session(cl_device_id device, const char* kernel_path = NULL, const char* cache_dir = NULL);
+	~Session();
+
+	bool ready() const 				{ return is_ready; }
+	cl_device_id device() const 	{ return device_id; }
+	cl_context context() const 		{ return ctx; }
+	cl_command_queue queue() const 	{ return cmd_queue; }
+
+	// Capabilities of the device from device_inventory(), NULL if it could not be queried
+	const DeviceInfo* info() const 	{ return device_info; }
+
+	// Device buffers and pinned host memory reused by every sample of the session
+	BufferPool& pool() 				{ return *buffer_pool; }
+
+	// CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT, the starting point for VECTOR_WIDTH
+	int preferred_vector_width() const;
+
+	// CL_DEVICE_MAX_WORK_GROUP_SIZE, or 0 when it cannot be queried
+	int max_work_group_size() const;
+
+	// Returns the kernel built with the given options, building it on first use
+	cl_kernel get_kernel(const std::string& options, const char* kernel_name);
+
+	// Number of programs compiled from source / loaded from the binary cache
+	int build_count() const 		{ return builds; }
+	int cache_hit_count() const 	{ return cache_hits; }
+
+private:
+	Session(const Session&);
+	Session& operator=(const Session&);
+
+	void open(cl_device_id device, const char* kernel_path);
+	cl_program get_program(const std::string& options);
+
+	bool 				is_ready;
+	int 				builds;
+	int 				cache_hits;
+	std::string 		source;
+	std::string 		cache_dir;
+	cl_device_id 		device_id;
+	const DeviceInfo* 	device_info;
+	cl_context 			ctx;
+	cl_command_queue 	cmd_queue;
+	BufferPool* 		buffer_pool;
+
+	std::map<std::string, cl_program> 	programs;
+	std::map<std::string, cl_kernel> 	kernels;
+};
+
+#endif
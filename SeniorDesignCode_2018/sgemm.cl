@@ -13,25 +13,300 @@
 //	Last Update: May 1st, 2018
 //	
 //	File Name: sgemm.cl
-//	Function(s): sgemm
+//	Function(s): sgemm, peak_flops and peak_copy (with -D CALIBRATE)
 //		Parameter(s):	__global float* C, const __global float*A, const __global float*B,
-//						const int dim
+//						const int M, const int N, const int K,
+//						const int lda, const int ldb, const int ldc,
+//						const float alpha, const float beta,
+//						[const int strideA, const int strideB, const int strideC]
 //
 //	Purpose:  	OpenCL Kernel Used to Execute Matrix Multiplication
 //				Given the choice between OpenCL global and local memory
 //				you can subdivide matrices to perform parallel execution	
 //
+//				LOCAL_MEM selects the variant:
+//					0 - every work-item reads A and B straight from global memory
+//					1 - square BLOCK_SIZE x BLOCK_SIZE tiles staged in local memory
+//					2 - TSM x TSN tile of C per work-group staged through TSK deep
+//						local tiles, with WPTM x WPTN outputs per work-item kept in
+//						registers
+//
+//				VECTOR_WIDTH (1, 2, 4 or 8) sets how many floats variants 0 and 2
+//				read from global memory per load, through vloadN/floatN.
+//
+//				C (M x N) = alpha * op(A) (M x K) * op(B) (K x N) + beta * C, all
+//				row-major with leading dimensions lda, ldb and ldc. With TRANS_A=1
+//				A is stored K x M and op(A) is its transpose, likewise TRANS_B=1
+//				stores B as N x K. Each layout is its own build, so every variant
+//				still reads its tiles along contiguous memory. With BETA_ZERO=1
+//				(the default) C is only written, never read.
+//
+//				With EDGE_GUARD=1 every load and store is bounds checked so any M,
+//				N and K work. With EDGE_GUARD=0 the host pads the matrices to whole
+//				tiles and the checks compile away.
+//
+//				With BATCHED=1 the kernel takes three more arguments, strideA,
+//				strideB and strideC, and multiplies get_global_size(2) matrices in
+//				one launch: matrix b of each operand starts b strides (in floats)
+//				after the first.
+//
+//				With CALIBRATE defined the program also holds the micro-benchmarks
+//				roofline.cpp times to estimate the peak compute rate and bandwidth.
+//
 /****************************************************************************************/
 
 
+#ifndef VECTOR_WIDTH
+#define VECTOR_WIDTH 1
+#endif
+
+#ifndef EDGE_GUARD
+#define EDGE_GUARD 0
+#endif
+
+#ifndef BATCHED
+#define BATCHED 0
+#endif
+
+#ifndef TRANS_A
+#define TRANS_A 0
+#endif
+
+#ifndef TRANS_B
+#define TRANS_B 0
+#endif
+
+#ifndef BETA_ZERO
+#define BETA_ZERO 1
+#endif
+
+// Element (m, k) of op(A) and (k, n) of op(B)
+#if TRANS_A
+#define A_AT(m, k) 			A[(k)*lda + (m)]
+#else
+#define A_AT(m, k) 			A[(m)*lda + (k)]
+#endif
+#if TRANS_B
+#define B_AT(k, n) 			B[(n)*ldb + (k)]
+#else
+#define B_AT(k, n) 			B[(k)*ldb + (n)]
+#endif
+
+// Scaled store of one result; C is read only when beta is not zero
+#if BETA_ZERO
+#define STORE_C(i, value) 	(C[i] = alpha*(value))
+#else
+#define STORE_C(i, value) 	(C[i] = alpha*(value) + beta*C[i])
+#endif
+
+// Vector type and load/store used for global memory accesses
+#if VECTOR_WIDTH == 8
+#define floatX 				float8
+#define vloadX(o, p) 		vload8(o, p)
+#define vstoreX(v, o, p) 	vstore8(v, o, p)
+#elif VECTOR_WIDTH == 4
+#define floatX 				float4
+#define vloadX(o, p) 		vload4(o, p)
+#define vstoreX(v, o, p) 	vstore4(v, o, p)
+#elif VECTOR_WIDTH == 2
+#define floatX 				float2
+#define vloadX(o, p) 		vload2(o, p)
+#define vstoreX(v, o, p) 	vstore2(v, o, p)
+#else
+#define floatX 				float
+#define vloadX(o, p) 		((p)[o])
+#define vstoreX(v, o, p) 	((p)[o] = (v))
+#endif
+
+#if LOCAL_MEM == 2
+
+// Work-items per work-group along M and N
+#define RTSM (TSM/WPTM)
+#define RTSN (TSN/WPTN)
+
+// Vector loads of A and B per work-item for each TSK deep tile
+#define LPTA ((TSK*TSM)/(RTSM*RTSN*VECTOR_WIDTH))
+#define LPTB ((TSK*TSN)/(RTSM*RTSN*VECTOR_WIDTH))
+
+#endif
+
 // OpenCL Matrix Multiplication Kernel
 __kernel void sgemm(__global float* C,
 					const __global float* A,
 					const __global float* B,
-					const int dim) {
-					  
+					const int M, const int N, const int K,
+					const int lda, const int ldb, const int ldc,
+					const float alpha, const float beta
+#if BATCHED
+					, const int strideA, const int strideB, const int strideC
+#endif
+					) {
+
+#if BATCHED
+		// The third NDRange dimension picks the matrix of the batch
+		const int batch = get_global_id(2);
+		A += batch*strideA;
+		B += batch*strideB;
+		C += batch*strideC;
+#endif
 					  
-#if LOCAL_MEM
+#if LOCAL_MEM == 2
+
+		// Thread index inside the work-group (0 runs along the columns of C)
+		const int tidn = get_local_id(0);
+		const int tidm = get_local_id(1);
+		const int tid  = tidm*RTSN + tidn;
+
+		// First row and column of the C tile computed by this work-group
+		const int offsetN = TSN*get_group_id(0);
+		const int offsetM = TSM*get_group_id(1);
+
+		// Local memory tiles; A is stored transposed so both are read along k
+		__local float Asub[TSK][TSM];
+		__local float Bsub[TSK][TSN];
+
+		// Private registers for the WPTM x WPTN outputs of this work-item
+		float Areg;
+		float Breg[WPTN];
+		float acc[WPTM][WPTN];
+		for (int wm = 0; wm < WPTM; wm++){
+			for (int wn = 0; wn < WPTN; wn++){
+				acc[wm][wn] = 0.0f;
+			}
+		}
+
+		// Loop over all TSK deep tiles of A and B
+		const int numTiles = (K + TSK - 1)/TSK;
+		for (int t = 0; t < numTiles; t++){
+
+			// Cooperatively load the TSM x TSK tile of A and the TSK x TSN tile of B,
+			// VECTOR_WIDTH consecutive floats of a row at a time
+#if TRANS_A
+			// A is stored K x M, already in the layout of Asub
+			for (int la = 0; la < LPTA; la++){
+				int id  = la*RTSM*RTSN + tid;
+				int row = id / (TSM/VECTOR_WIDTH);
+				int col = (id % (TSM/VECTOR_WIDTH))*VECTOR_WIDTH;
+				int globalK   = t*TSK + row;
+				int globalRow = offsetM + col;
+#if EDGE_GUARD
+				if (globalK < K && globalRow + VECTOR_WIDTH <= M){
+					vstoreX(vloadX(0, A + globalK*lda + globalRow), 0, &Asub[row][col]);
+				}
+				else {
+					for (int v = 0; v < VECTOR_WIDTH; v++){
+						Asub[row][col + v] = (globalK < K && globalRow + v < M) ? A[globalK*lda + globalRow + v] : 0.0f;
+					}
+				}
+#else
+				vstoreX(vloadX(0, A + globalK*lda + globalRow), 0, &Asub[row][col]);
+#endif
+			}
+#else
+			for (int la = 0; la < LPTA; la++){
+				int id  = la*RTSM*RTSN + tid;
+				int row = id / (TSK/VECTOR_WIDTH);
+				int col = (id % (TSK/VECTOR_WIDTH))*VECTOR_WIDTH;
+				int globalRow = offsetM + row;
+				int globalK   = t*TSK + col;
+				float vecA[VECTOR_WIDTH];
+#if EDGE_GUARD
+				if (globalRow < M && globalK + VECTOR_WIDTH <= K){
+					vstoreX(vloadX(0, A + globalRow*lda + globalK), 0, vecA);
+				}
+				else {
+					for (int v = 0; v < VECTOR_WIDTH; v++){
+						vecA[v] = (globalRow < M && globalK + v < K) ? A[globalRow*lda + globalK + v] : 0.0f;
+					}
+				}
+#else
+				vstoreX(vloadX(0, A + globalRow*lda + globalK), 0, vecA);
+#endif
+				for (int v = 0; v < VECTOR_WIDTH; v++){
+					Asub[col + v][row] = vecA[v];
+				}
+			}
+#endif
+#if TRANS_B
+			// B is stored N x K; rows of it become columns of Bsub
+			for (int lb = 0; lb < LPTB; lb++){
+				int id  = lb*RTSM*RTSN + tid;
+				int row = id / (TSK/VECTOR_WIDTH);
+				int col = (id % (TSK/VECTOR_WIDTH))*VECTOR_WIDTH;
+				int globalCol = offsetN + row;
+				int globalK   = t*TSK + col;
+				float vecB[VECTOR_WIDTH];
+#if EDGE_GUARD
+				if (globalCol < N && globalK + VECTOR_WIDTH <= K){
+					vstoreX(vloadX(0, B + globalCol*ldb + globalK), 0, vecB);
+				}
+				else {
+					for (int v = 0; v < VECTOR_WIDTH; v++){
+						vecB[v] = (globalCol < N && globalK + v < K) ? B[globalCol*ldb + globalK + v] : 0.0f;
+					}
+				}
+#else
+				vstoreX(vloadX(0, B + globalCol*ldb + globalK), 0, vecB);
+#endif
+				for (int v = 0; v < VECTOR_WIDTH; v++){
+					Bsub[col + v][row] = vecB[v];
+				}
+			}
+#else
+			for (int lb = 0; lb < LPTB; lb++){
+				int id  = lb*RTSM*RTSN + tid;
+				int row = id / (TSN/VECTOR_WIDTH);
+				int col = (id % (TSN/VECTOR_WIDTH))*VECTOR_WIDTH;
+				int globalK   = t*TSK + row;
+				int globalCol = offsetN + col;
+#if EDGE_GUARD
+				if (globalK < K && globalCol + VECTOR_WIDTH <= N){
+					vstoreX(vloadX(0, B + globalK*ldb + globalCol), 0, &Bsub[row][col]);
+				}
+				else {
+					for (int v = 0; v < VECTOR_WIDTH; v++){
+						Bsub[row][col + v] = (globalK < K && globalCol + v < N) ? B[globalK*ldb + globalCol + v] : 0.0f;
+					}
+				}
+#else
+				vstoreX(vloadX(0, B + globalK*ldb + globalCol), 0, &Bsub[row][col]);
+#endif
+			}
+#endif
+
+			// Synchronize to make sure the tiles are loaded
+			barrier(CLK_LOCAL_MEM_FENCE);
+
+			// Accumulate the outer product of one column of Asub and one row of Bsub
+			for (int k = 0; k < TSK; k++){
+				for (int wn = 0; wn < WPTN; wn++){
+					Breg[wn] = Bsub[k][tidn + wn*RTSN];
+				}
+				for (int wm = 0; wm < WPTM; wm++){
+					Areg = Asub[k][tidm + wm*RTSM];
+					for (int wn = 0; wn < WPTN; wn++){
+						acc[wm][wn] += Areg * Breg[wn];
+					}
+				}
+			}
+
+			// Synchronize before the next tiles overwrite Asub and Bsub
+			barrier(CLK_LOCAL_MEM_FENCE);
+		}
+
+		// Store the WPTM x WPTN results; neighbouring work-items write neighbouring columns
+		for (int wm = 0; wm < WPTM; wm++){
+			int globalRow = offsetM + tidm + wm*RTSM;
+			for (int wn = 0; wn < WPTN; wn++){
+				int globalCol = offsetN + tidn + wn*RTSN;
+#if EDGE_GUARD
+				if (globalRow < M && globalCol < N)
+#endif
+				STORE_C(globalRow*ldc + globalCol, acc[wm][wn]);
+			}
+		}
+
+#elif LOCAL_MEM
 
 		// Block index
     	int bx = get_group_id(0);
@@ -41,24 +316,16 @@ __kernel void sgemm(__global float* C,
     	int tx = get_local_id(0);
     	int ty = get_local_id(1);
     	
-    	// Index of the first sub-matrix of A processed by the block
-    	int aBegin = dim * BLOCK_SIZE * by;
-    	
-    	// Index of the last sub-matrix of A processed by the block
-    	int aEnd   = aBegin + dim - 1;
-    	
-    	// Step size used to iterate through the sub-matrices of A
-    	int aStep  = BLOCK_SIZE;
- 
-    	// Index of the first sub-matrix of B processed by the block
-    	int bBegin = BLOCK_SIZE * bx;
+    	// Row of A and column of B used by this thread
+    	int row = BLOCK_SIZE * by + ty;
+    	int col = BLOCK_SIZE * bx + tx;
  
-    	// Step size used to iterate through the sub-matrices of B
-    	int bStep  = BLOCK_SIZE * dim;
+    	// Number of BLOCK_SIZE wide sub-matrices along K
+    	int numBlocks = (K + BLOCK_SIZE - 1) / BLOCK_SIZE;
  
    	 	// Loop over all the sub-matrices of A and B required to compute the block sub-matrix
     	float Csub = 0.0;
-    	for (int a = aBegin, b = bBegin; a <= aEnd; a += aStep, b += bStep){
+    	for (int blk = 0; blk < numBlocks; blk++){
 
         	// Declaration of the local memory array As used to store the sub-matrix of A
         	__local float As[BLOCK_SIZE][BLOCK_SIZE];
@@ -67,9 +334,40 @@ __kernel void sgemm(__global float* C,
         	__local float Bs[BLOCK_SIZE][BLOCK_SIZE];
  
         	// Load the matrices from global memory to local memory; each thread loads
-        	// one element of each matrix
-        	As[ty][tx] = A[a + dim * ty + tx];
-        	Bs[ty][tx] = B[b + dim * ty + tx];
+        	// one element of each matrix. A transposed operand is read with the thread
+        	// indices swapped so neighbouring threads still read neighbouring floats.
+#if TRANS_A
+        	int am = BLOCK_SIZE * by + tx;
+        	int ak = BLOCK_SIZE * blk + ty;
+#if EDGE_GUARD
+        	As[tx][ty] = (am < M && ak < K) ? A_AT(am, ak) : 0.0f;
+#else
+        	As[tx][ty] = A_AT(am, ak);
+#endif
+#else
+        	int ka = BLOCK_SIZE * blk + tx;
+#if EDGE_GUARD
+        	As[ty][tx] = (row < M && ka < K) ? A_AT(row, ka) : 0.0f;
+#else
+        	As[ty][tx] = A_AT(row, ka);
+#endif
+#endif
+#if TRANS_B
+        	int bk = BLOCK_SIZE * blk + tx;
+        	int bn = BLOCK_SIZE * bx + ty;
+#if EDGE_GUARD
+        	Bs[tx][ty] = (bk < K && bn < N) ? B_AT(bk, bn) : 0.0f;
+#else
+        	Bs[tx][ty] = B_AT(bk, bn);
+#endif
+#else
+        	int kb = BLOCK_SIZE * blk + ty;
+#if EDGE_GUARD
+        	Bs[ty][tx] = (kb < K && col < N) ? B_AT(kb, col) : 0.0f;
+#else
+        	Bs[ty][tx] = B_AT(kb, col);
+#endif
+#endif
  
         	// Synchronize to make sure the matrices 
         	// are loaded
@@ -90,29 +388,93 @@ __kernel void sgemm(__global float* C,
  
     	// Write the block sub-matrix to device memory;
     	// each thread writes one element
-    	int c = dim * BLOCK_SIZE * by + BLOCK_SIZE * bx;
-    	C[c + dim * ty + tx] = Csub;
+#if EDGE_GUARD
+    	if (row < M && col < N)
+#endif
+    	STORE_C(row * ldc + col, Csub);
     	
     	
 #else 
     
+    	// Each work-item computes VECTOR_WIDTH neighbouring elements of one row of C
     	const int globalRow = get_global_id(0); 
-   		const int globalCol = get_global_id(1);
+   		const int globalCol = get_global_id(1)*VECTOR_WIDTH;
+
+#if EDGE_GUARD
+   		// Work-items past the edge do nothing; a partial vector at the right edge
+   		// falls back to scalar loads
+   		if (globalRow >= M || globalCol >= N)
+   			return;
+   		if (globalCol + VECTOR_WIDTH > N){
+   			for (int col = globalCol; col < N; col++){
+   				float accEdge = 0.0f;
+   				for (int k = 0; k < K; k++){
+   					accEdge += A_AT(globalRow, k) * B_AT(k, col);
+   				}
+   				STORE_C(globalRow*ldc + col, accEdge);
+   			}
+   			return;
+   		}
+#endif
     	 
-    	// value stores the element that is 
+    	// value stores the elements that are 
 		// computed by the thread
-   		float acc = 0.0;
-   		for (int k = 0; k < dim; k++){
-      		float elementA = A[globalRow * dim + k];
-      		float elementB = B[k * dim + globalCol];
+   		floatX acc = (floatX)(0.0f);
+   		for (int k = 0; k < K; k++){
+      		float  elementA = A_AT(globalRow, k);
+#if TRANS_B
+      		// The columns of op(B) are rows of B; gather one float of each
+      		float  columnB[VECTOR_WIDTH];
+      		for (int v = 0; v < VECTOR_WIDTH; v++){
+      			columnB[v] = B_AT(k, globalCol + v);
+      		}
+      		floatX elementB = vloadX(0, columnB);
+#else
+      		floatX elementB = vloadX(0, B + k * ldb + globalCol);
+#endif
       		acc += elementA * elementB;
    		}
    		
    		// Store the final result in C
-    	C[globalRow*dim + globalCol] = acc;
-    
+#if BETA_ZERO
+    	vstoreX(alpha*acc, 0, C + globalRow*ldc + globalCol);
+#else
+    	vstoreX(alpha*acc + beta*vloadX(0, C + globalRow*ldc + globalCol), 0, C + globalRow*ldc + globalCol);
 #endif
     
-    // Store the final result in C
-    //C[globalRow*dim + globalCol] = acc;
-}
\ No newline at end of file
+#endif
+}
+
+
+#ifdef CALIBRATE
+
+#ifndef CAL_ITERS
+#define CAL_ITERS 1024
+#endif
+
+// Peak arithmetic rate: CAL_ITERS rounds of four independent float4 multiply-adds,
+// 32 flops per round per work-item
+__kernel void peak_flops(__global float* out, const float seed) {
+		const int gid = get_global_id(0);
+		float4 x0 = (float4)(seed + gid);
+		float4 x1 = (float4)(seed - gid);
+		float4 x2 = (float4)(seed * 0.5f);
+		float4 x3 = (float4)(seed * 0.25f);
+		const float4 y = (float4)(0.999f);
+		const float4 z = (float4)(0.001f);
+		for (int i = 0; i < CAL_ITERS; i++){
+			x0 = mad(x0, y, z);
+			x1 = mad(x1, y, z);
+			x2 = mad(x2, y, z);
+			x3 = mad(x3, y, z);
+		}
+		vstore4(x0 + x1 + x2 + x3, gid, out);
+}
+
+// Peak bandwidth: every work-item copies one float4
+__kernel void peak_copy(__global float* dst, const __global float* src) {
+		const int gid = get_global_id(0);
+		vstore4(vload4(gid, src), gid, dst);
+}
+
+#endif
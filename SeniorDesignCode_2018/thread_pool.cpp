@@ -0,0 +1,203 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: thread_pool.cpp
+//	Function(s): ThreadPool::parallel_for(), cpu_thread_pool(), available_cores()
+//
+//	Purpose: 	Work-stealing thread pool for the CPU SGEMM. Workers live as long as
+//				the pool, so a sweep does not pay for thread creation on every run,
+//				and on Linux each one is pinned to its own core. Pinned workers that
+//				allocate and first touch their own buffers get pages on their own NUMA
+//				node, which is what cpu_sgemm() relies on for the packed blocks.
+//
+/****************************************************************************************/
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <map>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Cores in the affinity mask of the process, in order
+static std::vector<int> allowed_cores()
+{
+	std::vector<int> cores;
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set) == 0){
+		for (int c = 0; c < CPU_SETSIZE; c++){
+			if (CPU_ISSET(c, &set))
+				cores.push_back(c);
+		}
+	}
+#endif
+	if (cores.empty()){
+		int count = std::max(1u, std::thread::hardware_concurrency());
+		for (int c = 0; c < count; c++)
+			cores.push_back(c);
+	}
+	return cores;
+}
+
+int available_cores()
+{
+	return (int) allowed_cores().size();
+}
+
+// Bind the calling thread to one core; a no-op where affinity is not supported
+static void pin_to_core(const int core)
+{
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+	(void) core;
+#endif
+}
+
+ThreadPool::ThreadPool(int threads, bool pin)
+	: pin(pin), stopping(false), generation(0), busy(0), job(NULL), steals(0)
+{
+	std::vector<int> cores = allowed_cores();
+	if (threads <= 0)
+		threads = cores.size();
+
+	for (int i = 0; i < threads; i++)
+		queues.push_back(std::unique_ptr<TaskQueue>(new TaskQueue()));
+
+	// Compact placement: neighbouring workers share a socket as long as possible
+	for (int i = 0; i < threads; i++){
+		int core = cores[i % cores.size()];
+		workers.push_back(std::thread([this, i, core]() {
+			if (this->pin)
+				pin_to_core(core);
+			worker_loop(i);
+		}));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+}
+
+void ThreadPool::parallel_for(const int tasks, const std::function<void(int, int)>& task)
+{
+	if (tasks <= 0)
+		return;
+
+	// Waiting for the workers releases lock, so a second caller is held off here
+	std::lock_guard<std::mutex> call(calls);
+	std::unique_lock<std::mutex> guard(lock);
+
+	// Worker w starts with the w-th contiguous range, so neighbouring tasks (which
+	// usually share packed data) run on the same core unless they are stolen
+	int n = size();
+	for (int w = 0; w < n; w++){
+		std::lock_guard<std::mutex> queue_guard(queues[w]->lock);
+		queues[w]->tasks.clear();
+		for (int t = (long long) w * tasks / n; t < (long long) (w + 1) * tasks / n; t++)
+			queues[w]->tasks.push_back(t);
+	}
+
+	job = &task;
+	busy = n;
+	generation++;
+	wake.notify_all();
+	finished.wait(guard, [this]() { return busy == 0; });
+	job = NULL;
+}
+
+void ThreadPool::worker_loop(const int id)
+{
+	int seen = 0;
+	for (;;){
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			wake.wait(guard, [this, seen]() { return stopping || generation != seen; });
+			if (stopping)
+				return;
+			seen = generation;
+		}
+
+		run_tasks(id);
+
+		std::lock_guard<std::mutex> guard(lock);
+		if (--busy == 0)
+			finished.notify_one();
+	}
+}
+
+void ThreadPool::run_tasks(const int id)
+{
+	int task;
+	while (next_task(id, task))
+		(*job)(task, id);
+}
+
+bool ThreadPool::next_task(const int id, int& task)
+{
+	// Own queue from the front
+	{
+		TaskQueue& own = *queues[id];
+		std::lock_guard<std::mutex> guard(own.lock);
+		if (!own.tasks.empty()){
+			task = own.tasks.front();
+			own.tasks.pop_front();
+			return true;
+		}
+	}
+
+	// Other queues from the back, starting with the next worker
+	int n = size();
+	for (int i = 1; i < n; i++){
+		TaskQueue& victim = *queues[(id + i) % n];
+		std::lock_guard<std::mutex> guard(victim.lock);
+		if (!victim.tasks.empty()){
+			task = victim.tasks.back();
+			victim.tasks.pop_back();
+			steals++;
+			return true;
+		}
+	}
+	return false;
+}
+
+ThreadPool& cpu_thread_pool(int threads)
+{
+	static std::mutex pool_lock;
+	static std::map<int, std::unique_ptr<ThreadPool>> pools;
+
+	if (threads <= 0)
+		threads = available_cores();
+
+	std::lock_guard<std::mutex> guard(pool_lock);
+	std::unique_ptr<ThreadPool>& pool = pools[threads];
+	if (!pool)
+		pool.reset(new ThreadPool(threads));
+	return *pool;
+}
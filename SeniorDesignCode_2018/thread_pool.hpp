@@ -0,0 +1,86 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: thread_pool.hpp
+//	Purpose of File: Header File for thread_pool.cpp
+//
+/****************************************************************************************/
+
+#ifndef THREAD_POOL
+#define THREAD_POOL
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of cores this process may run on
+int available_cores();
+
+// Fixed set of worker threads that run parallel loops. Each worker starts with a
+// contiguous range of the tasks in its own queue and, once that is empty, steals
+// from the far end of another worker's queue, so uneven tasks still finish together.
+class ThreadPool {
+public:
+	// threads = 0 uses every available core; pin binds worker i to the i-th core
+	explicit ThreadPool(int threads = 0, bool pin = true);
+	~ThreadPool();
+
+	int size() const 			{ return (int) queues.size(); }
+	bool pinned() const 		{ return pin; }
+
+	// Run task(t, worker) for every t in [0, tasks) on the workers and wait for all of
+	// them. Calls from several threads run one after the other; a task must not call
+	// parallel_for on the same pool.
+	void parallel_for(const int tasks, const std::function<void(int, int)>& task);
+
+	// Tasks taken from another worker's queue since the pool started
+	long long steal_count() const 	{ return steals; }
+
+private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	struct TaskQueue {
+		std::mutex 		lock;
+		std::deque<int> tasks;
+	};
+
+	void worker_loop(const int id);
+	void run_tasks(const int id);
+	bool next_task(const int id, int& task);
+
+	bool 		pin;
+	bool 		stopping;
+	int 		generation;		// bumped for every parallel_for so sleeping workers wake
+	int 		busy;			// workers still running tasks of the current loop
+	const std::function<void(int, int)>* job;
+
+	std::vector<std::unique_ptr<TaskQueue>> queues;
+	std::vector<std::thread> 				workers;
+	std::mutex 								calls;	// one parallel_for at a time
+	std::mutex 								lock;
+	std::condition_variable 				wake, finished;
+	std::atomic<long long> 					steals;
+};
+
+// Pool shared by the CPU SGEMM. There is one per thread count, kept until exit, so a
+// caller never loses its pool (or the buffers its workers touched) to another count
+ThreadPool& cpu_thread_pool(int threads = 0);
+
+#endif
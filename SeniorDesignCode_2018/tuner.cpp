@@ -0,0 +1,591 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: tuner.cpp
+//	Function(s): tune(), tune_cpu(), expected_improvement(), default_tuner_options(),
+//				 parse_strategy(), parse_objective(), MeasureCache::find(),
+//				 MeasureCache::store()
+//
+//	Purpose: 	Active-learning search over the kernel parameter space. Instead of
+//				drawing configurations uniformly, a random forest is refit after every
+//				launch and the spread of its trees is used as the uncertainty of each
+//				prediction. The next configuration launched is the one with the largest
+//				expected improvement over the best time measured so far, and the search
+//				stops when no candidate is expected to gain enough to be worth a launch.
+//				The model is fit to log(time), so improvements are relative: a gain of
+//				0.01 means about 1% faster than the best so far. Each measured time is
+//				the median of repeated launches (benchmark.cpp). The same search runs
+//				over the OpenCL kernel parameters and over the CPU blocking (cpu_sgemm.cpp).
+//
+//				The model needs every candidate enumerated, which stops working once a
+//				search space has millions of points. A genetic algorithm and simulated
+//				annealing walk the points of a SearchSpace instead, and only launch the
+//				ones they visit. Every strategy records the best time after each launch,
+//				so their convergence can be compared on the same device.
+//
+//				Hopeless configurations are not run in full: a launch stops once it is
+//				abort_factor times slower than the best so far, large shapes are first
+//				timed with K cut short, and the local searches ask the forest of their
+//				measurements for a lower bound before launching a point at all.
+//
+//				By default configurations are ranked by their kernel time. The end to
+//				end objective adds the host work and the transfers of each run, which is
+//				what a caller multiplying matrices that live on the host pays.
+//
+/****************************************************************************************/
+
+#include "tuner.hpp"
+#include "random_forest.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <set>
+
+TunerOptions default_tuner_options()
+{
+	TunerOptions options;
+	options.initial_samples = 8;
+	options.max_launches 	= 100;
+	options.min_gain 		= 0.01;
+	options.n_trees 		= 50;
+	options.batch 			= 1;
+	options.trans_a 		= NO_TRANS;
+	options.trans_b 		= NO_TRANS;
+	options.strategy 		= SEARCH_MODEL;
+	options.space 			= NULL;
+	options.population 		= 16;
+	options.mutation 		= 0.2;
+	options.temperature 	= 0.1;
+	options.cooling 		= 0.95;
+	options.abort_factor 	= 4.0;
+	options.proxy_volume 	= 512.0 * 512.0 * 512.0;
+	options.proxy_divisor 	= 8;
+	options.objective 		= OBJECTIVE_KERNEL;
+	options.results 		= NULL;
+	options.bench 			= default_benchmark_options();
+	options.verify 			= default_verify_options(VERIFY_FREIVALDS);
+	return options;
+}
+
+bool parse_strategy(const std::string& name, SearchStrategy& strategy)
+{
+	if (name == "model")
+		strategy = SEARCH_MODEL;
+	else if (name == "genetic")
+		strategy = SEARCH_GENETIC;
+	else if (name == "annealing")
+		strategy = SEARCH_ANNEALING;
+	else
+		return false;
+	return true;
+}
+
+const char* strategy_name(const SearchStrategy strategy)
+{
+	static const char* names[] = {"model", "genetic", "annealing"};
+	return names[strategy];
+}
+
+bool parse_objective(const std::string& name, TimeObjective& objective)
+{
+	if (name == "kernel")
+		objective = OBJECTIVE_KERNEL;
+	else if (name == "total")
+		objective = OBJECTIVE_END_TO_END;
+	else
+		return false;
+	return true;
+}
+
+bool MeasureCache::find(const KernelConfig& config, double& time, double* kernel_time) const
+{
+	std::map<std::string, std::pair<double, double> >::const_iterator it;
+	it = times.find(build_options(config));
+	if (it == times.end())
+		return false;
+	time = it->second.first;
+	if (kernel_time)
+		*kernel_time = it->second.second;
+	return true;
+}
+
+void MeasureCache::store(const KernelConfig& config, const double time, const double kernel_time)
+{
+	times[build_options(config)] = std::make_pair(time, kernel_time);
+}
+
+double expected_improvement(double best, double mean, double stddev)
+{
+	if (stddev <= 0.0)
+		return std::max(best - mean, 0.0);
+
+	double z = (best - mean) / stddev;
+	double cdf = 0.5 * erfc(-z / sqrt(2.0));
+	double pdf = exp(-0.5 * z * z) / sqrt(2.0 * M_PI);
+	return (best - mean) * cdf + stddev * pdf;
+}
+
+// Launch one configuration unless the cache has it, record it and keep track of the
+// best time
+static double measure(Session& session, const int M, const int N, const int K,
+					  const KernelConfig& config, const TunerOptions& options,
+					  std::ofstream& csv, TunerResult& result, MeasureCache* cache)
+{
+	double time, kernel_time;
+	bool cached = cache && cache->find(config, time, &kernel_time);
+	if (cached){
+		result.cached++;
+	}
+	else {
+		printf("Launch %d\n", result.launches);
+		print_inputs(M, N, K, config);
+
+		// Launches stop once they are abort_factor times slower than the best so far
+		BenchmarkOptions bench = options.bench;
+		if (options.abort_factor > 0 && result.best_time > 0)
+			bench.abort_ms = options.abort_factor * result.best_time;
+
+		// On a large shape one unchecked launch with K cut short is timed first and
+		// scaled to the full depth; a configuration already past the cutoff stops there
+		bool proxied = false;
+		if (bench.abort_ms > 0 && options.proxy_divisor > 1 && (double) M * N * K >= options.proxy_volume){
+			int proxy_K = std::max(1, K / options.proxy_divisor);
+			BenchmarkOptions once = single_run_options();
+			once.warmup = 1;
+			VerifyOptions unchecked = default_verify_options(VERIFY_NONE);
+			double proxy = options.batch > 1
+						 ? host_batched(session, M, N, proxy_K, options.batch, config, 0, &once, NULL, &unchecked)
+						 : host(session, M, N, proxy_K, config, 0, &once, NULL, &unchecked,
+								options.trans_a, options.trans_b);
+			if (proxy > 0 && proxy * K / proxy_K > bench.abort_ms){
+				time = proxy * K / proxy_K;
+				proxied = true;
+				printf("	Stopped, the K = %d proxy scales to %.3f ms\n", proxy_K, time);
+			}
+		}
+
+		BenchmarkStats stats = summarize(std::vector<double>(), 0);
+		if (!proxied){
+			time = options.batch > 1
+				 ? host_batched(session, M, N, K, options.batch, config, 0, &bench, &stats, &options.verify)
+				 : host(session, M, N, K, config, 0, &bench, &stats, &options.verify,
+						options.trans_a, options.trans_b);
+			printf("	Outputs (ms): [%.3f]\n", time);
+		}
+		if (proxied || stats.aborted)
+			result.aborted++;
+
+		// A proxy estimate is not a measurement of this shape, so it stays out of the
+		// dataset; a run stopped by the cutoff still timed the full kernel
+		if (csv.is_open() && !proxied)
+			write_csv_row(csv, time, M, N, K, config, session.info(), options.batch,
+						  options.trans_a, options.trans_b, &stats.phases);
+		if (options.results && !proxied)
+			options.results->append(make_record("tune", time, M, N, K, config, &stats, options.batch,
+												options.trans_a, options.trans_b));
+
+		// The dataset keeps the kernel time; the search ranks by the chosen objective
+		kernel_time = time;
+		if (!proxied && time > 0 && options.objective == OBJECTIVE_END_TO_END)
+			time = end_to_end(stats.phases);
+		if (cache)
+			cache->store(config, time, kernel_time);
+		result.launches++;
+	}
+
+	double& variant = result.variant_time[config.local_mem];
+	if (time >= 0 && (variant < 0 || time < variant)){
+		variant = time;
+		result.variant_kernel_time[config.local_mem] = kernel_time;
+	}
+	if (time >= 0 && (result.best_time < 0 || time < result.best_time)){
+		result.best_time = time;
+		result.best_kernel_time = kernel_time;
+		result.best = config;
+	}
+	if (!cached)
+		result.history.push_back(result.best_time);
+	return time;
+}
+
+// Whether time a (ms, -1 on failure) beats time b
+static bool faster(double a, double b)
+{
+	return a > 0 && (b <= 0 || a < b);
+}
+
+// Bound on the points a local search visits, since points found in the cache are free
+static int visit_limit(const TunerOptions& options)
+{
+	return 20 * std::max(1, options.max_launches);
+}
+
+// Genetic search over the points of a space. evaluate() returns the time of a point or
+// -1 when it cannot run or the model rules it out. Each generation keeps its best point
+// and breeds the others from tournaments of two, with uniform crossover and
+// per-parameter mutation.
+static void genetic_search(const SearchSpace& space, const TunerOptions& options,
+						   const std::function<double(const std::vector<int>&)>& evaluate,
+						   const int& launches)
+{
+	std::mt19937 rng(2018);
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	int population = std::max(2, options.population);
+	int visits = 0;
+
+	std::vector<std::vector<int> > points(population);
+	std::vector<double> times(population, -1);
+	for (int i = 0; i < population && launches < options.max_launches; i++){
+		space.random_point(rng, points[i]);
+		times[i] = evaluate(points[i]);
+		visits++;
+	}
+
+	while (launches < options.max_launches && visits < visit_limit(options)){
+		int best = 0;
+		for (int i = 1; i < population; i++){
+			if (faster(times[i], times[best]))
+				best = i;
+		}
+
+		std::vector<std::vector<int> > next(1, points[best]);
+		std::vector<double> next_times(1, times[best]);
+		while ((int) next.size() < population && launches < options.max_launches &&
+			   visits < visit_limit(options)){
+			int a = rng() % population, b = rng() % population;
+			int mother = faster(times[a], times[b]) ? a : b;
+			a = rng() % population;
+			b = rng() % population;
+			int father = faster(times[a], times[b]) ? a : b;
+
+			std::vector<int> child(points[mother]);
+			for (size_t p = 0; p < child.size(); p++){
+				if (rng() % 2)
+					child[p] = points[father][p];
+			}
+			space.repair(child, rng);
+			for (size_t p = 0; p < child.size(); p++){
+				if (uniform(rng) < options.mutation)
+					space.mutate(child, p, rng);
+			}
+
+			next.push_back(child);
+			next_times.push_back(evaluate(child));
+			visits++;
+		}
+
+		// A generation cut short by the budget keeps the rest of the old one
+		for (size_t i = next.size(); i < points.size(); i++){
+			next.push_back(points[i]);
+			next_times.push_back(times[i]);
+		}
+		points.swap(next);
+		times.swap(next_times);
+	}
+}
+
+// Simulated annealing over the points of a space: each move changes one parameter, and
+// a slower point is accepted with probability exp(-log(slowdown) / temperature), the
+// temperature shrinking after every move
+static void annealing_search(const SearchSpace& space, const TunerOptions& options,
+							 const std::function<double(const std::vector<int>&)>& evaluate,
+							 const int& launches)
+{
+	std::mt19937 rng(2018);
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	int visits = 0;
+
+	// Start from the first random point that runs
+	std::vector<int> current;
+	double current_time = -1;
+	while (current_time <= 0 && launches < options.max_launches && visits < visit_limit(options)){
+		space.random_point(rng, current);
+		current_time = evaluate(current);
+		visits++;
+	}
+	if (current_time <= 0)
+		return;
+
+	double temperature = options.temperature;
+	while (launches < options.max_launches && visits < visit_limit(options)){
+		std::vector<int> active;
+		for (size_t p = 0; p < current.size(); p++){
+			if (current[p] >= 0)
+				active.push_back(p);
+		}
+		if (active.empty())
+			break;
+
+		std::vector<int> candidate(current);
+		space.mutate(candidate, active[rng() % active.size()], rng);
+		double time = evaluate(candidate);
+		visits++;
+
+		if (time > 0){
+			double slowdown = log(time) - log(current_time);
+			if (slowdown <= 0 || (temperature > 0 && uniform(rng) < exp(-slowdown / temperature))){
+				current.swap(candidate);
+				current_time = time;
+			}
+		}
+		temperature *= options.cooling;
+	}
+}
+
+// Model-guided search over candidates described by their features. measure(c) runs
+// candidate c, counting it in launches, and returns its time (<= 0 when it failed);
+// strata[c] in [0, n_strata) groups the candidates so the random seeds cover every group.
+static void model_search(const std::vector<Sample>& features, const std::vector<int>& strata,
+						 const int n_strata, const TunerOptions& options,
+						 const std::function<double(int)>& measure, int& launches)
+{
+	std::vector<bool> tried(features.size(), false);
+	std::vector<Sample> x_seen;
+	std::vector<double> y_seen;
+	int budget = std::min(options.max_launches, (int) features.size());
+	double best = -1;
+
+	// Random configurations to give the model a starting point, taken from each group
+	// in turn; the largest group would otherwise fill almost every draw
+	std::mt19937 rng(2018);
+	std::vector<int> order(features.size());
+	for (size_t i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::shuffle(order.begin(), order.end(), rng);
+
+	while (launches < budget){
+
+		int next = -1;
+		double next_gain = 0.0;
+		if (launches < options.initial_samples || x_seen.size() < 2){
+			// Seeds, or not enough successful launches for a model yet
+			for (size_t j = 0; j < order.size() && next < 0; j++){
+				if (!tried[order[j]] && strata[order[j]] == launches % n_strata)
+					next = order[j];
+			}
+			for (size_t j = 0; j < order.size() && next < 0; j++){
+				if (!tried[order[j]])
+					next = order[j];
+			}
+		}
+		else {
+			// A third of the inputs per split keeps the trees diverse enough to disagree
+			int split_features = std::max(1, (int) features[0].size() / 3);
+			RandomForest rf(options.n_trees, 32, 1, split_features, 2018 + launches);
+			rf.fit(x_seen, y_seen);
+
+			std::vector<double> per_tree;
+			for (size_t c = 0; c < features.size(); c++){
+				if (tried[c])
+					continue;
+				rf.predict_trees(features[c], per_tree);
+				double mean = 0.0, var = 0.0;
+				for (size_t t = 0; t < per_tree.size(); t++)
+					mean += per_tree[t];
+				mean /= per_tree.size();
+				for (size_t t = 0; t < per_tree.size(); t++)
+					var += (per_tree[t] - mean) * (per_tree[t] - mean);
+				var /= per_tree.size();
+
+				double gain = expected_improvement(log(best), mean, sqrt(var));
+				if (next < 0 || gain > next_gain){
+					next = c;
+					next_gain = gain;
+				}
+			}
+
+			if (next < 0)
+				break;
+			printf("	Expected improvement: [%.2f%%]\n", 100.0 * next_gain);
+			if (next_gain < options.min_gain){
+				printf("	Expected improvement is below %.1f%% of the best time, stopping\n",
+					   100.0 * options.min_gain);
+				break;
+			}
+		}
+		if (next < 0)
+			break;
+
+		tried[next] = true;
+		double time = measure(next);
+		if (time > 0){
+			x_seen.push_back(features[next]);
+			y_seen.push_back(log(time));
+			if (best < 0 || time < best)
+				best = time;
+		}
+	}
+}
+
+TunerResult tune(Session& session, const int M, const int N, const int K,
+				 const TunerOptions& options, std::ofstream& csv, MeasureCache* cache)
+{
+	TunerResult result;
+	result.best = make_config(1, 1);
+	result.best_time = -1;
+	result.variant_time[0] = result.variant_time[1] = result.variant_time[2] = -1;
+	result.best_kernel_time = -1;
+	for (int v = 0; v < 3; v++)
+		result.variant_kernel_time[v] = -1;
+	result.launches = 0;
+	result.candidates = 0;
+	result.cached = 0;
+	result.aborted = 0;
+	result.skipped = 0;
+
+	// Without a shared cache the run keeps its own, so it never launches a point twice
+	MeasureCache own_cache;
+	if (!cache)
+		cache = &own_cache;
+
+	if (options.strategy != SEARCH_MODEL){
+		SearchSpace default_space;
+		const SearchSpace* space = options.space;
+		if (!space){
+			default_search_space(default_space);
+			space = &default_space;
+		}
+
+		// The points measured so far train a forest. Once it has seen initial_samples of
+		// them, a new point whose fastest tree is still abort_factor times behind the best
+		// is rejected like one that cannot run, and stays rejected when it is met again.
+		std::vector<Sample> x_seen;
+		std::vector<double> y_seen;
+		std::set<std::string> learned;
+		std::set<std::string> ruled_out;
+		RandomForest forest;
+		size_t fitted = 0;
+		std::vector<double> per_tree;
+
+		// Points the kernel cannot build or the device cannot launch are never sent
+		std::function<double(const std::vector<int>&)> evaluate = [&](const std::vector<int>& point) {
+			KernelConfig config = space->to_config(point);
+			if (!check_config(config, 0) || (session.info() && !config_fits(config, *session.info())))
+				return -1.0;
+			std::string key = build_options(config);
+			if (ruled_out.count(key))
+				return -1.0;
+			Sample features = config_features(M, N, K, config, session.info(), options.batch,
+											  options.trans_a, options.trans_b);
+
+			double time;
+			if (!cache->find(config, time) && options.abort_factor > 0 && result.best_time > 0 &&
+				(int) y_seen.size() >= std::max(2, options.initial_samples)){
+				if (fitted != y_seen.size()){
+					forest = RandomForest(options.n_trees, 32, 1, std::max(1, (int) features.size() / 3),
+										  2018 + y_seen.size());
+					forest.fit(x_seen, y_seen);
+					fitted = y_seen.size();
+				}
+				forest.predict_trees(features, per_tree);
+				double bound = *std::min_element(per_tree.begin(), per_tree.end());
+				if (exp(bound) > options.abort_factor * result.best_time){
+					ruled_out.insert(key);
+					result.skipped++;
+					return -1.0;
+				}
+			}
+
+			time = measure(session, M, N, K, config, options, csv, result, cache);
+			if (time > 0 && learned.insert(key).second){
+				x_seen.push_back(features);
+				y_seen.push_back(log(time));
+			}
+			return time;
+		};
+		if (options.strategy == SEARCH_GENETIC)
+			genetic_search(*space, options, evaluate, result.launches);
+		else
+			annealing_search(*space, options, evaluate, result.launches);
+		return result;
+	}
+
+	// Candidates the device can launch at all
+	std::vector<KernelConfig> candidates;
+	enumerate_configs(candidates, session.info());
+	result.candidates = candidates.size();
+	if (candidates.empty())
+		return result;
+
+	// Seeds rotate through the kernel variants
+	std::vector<Sample> features(candidates.size());
+	std::vector<int> strata(candidates.size());
+	for (size_t i = 0; i < candidates.size(); i++){
+		features[i] = config_features(M, N, K, candidates[i], session.info(), options.batch,
+									  options.trans_a, options.trans_b);
+		strata[i] = candidates[i].local_mem;
+	}
+
+	// Expected improvement already passes over the candidates the forest rules out, so
+	// only the cutoff and the proxy of measure() apply here
+	model_search(features, strata, 3, options,
+				 [&](int c) { return measure(session, M, N, K, candidates[c], options, csv, result, cache); },
+				 result.launches);
+	return result;
+}
+
+// Launch one CPU configuration, record it and keep track of the best time
+static double measure_cpu(const int M, const int N, const int K, const CpuConfig& config,
+						  CpuIsa isa, const TunerOptions& options, std::ofstream& csv,
+						  CpuTunerResult& result)
+{
+	printf("Launch %d\n", result.launches);
+	print_cpu_inputs(M, N, K, config);
+	double time = run_cpu_sgemm(M, N, K, config, isa, &options.bench, NULL, &options.verify);
+	printf("	Outputs (ms): [%.3f]\n", time);
+
+	if (csv.is_open())
+		write_cpu_csv_row(csv, time, M, N, K, config);
+
+	result.launches++;
+	if (time >= 0 && (result.best_time < 0 || time < result.best_time)){
+		result.best_time = time;
+		result.best = config;
+	}
+	return time;
+}
+
+CpuTunerResult tune_cpu(const int M, const int N, const int K, CpuIsa isa,
+						const TunerOptions& options, std::ofstream& csv)
+{
+	CpuTunerResult result;
+	result.best = default_cpu_config(isa);
+	result.best_time = -1;
+	result.launches = 0;
+
+	std::vector<CpuConfig> candidates;
+	enumerate_cpu_configs(isa, candidates);
+	result.candidates = candidates.size();
+	if (candidates.empty())
+		return result;
+
+	// Seeds rotate through the micro-tile shapes
+	std::vector<Sample> features(candidates.size());
+	std::vector<int> strata(candidates.size());
+	std::vector<int> tiles;
+	for (size_t i = 0; i < candidates.size(); i++){
+		features[i] = cpu_config_features(M, N, K, candidates[i]);
+		int tile = candidates[i].mr * 1000 + candidates[i].nr;
+		size_t s = std::find(tiles.begin(), tiles.end(), tile) - tiles.begin();
+		if (s == tiles.size())
+			tiles.push_back(tile);
+		strata[i] = s;
+	}
+
+	model_search(features, strata, tiles.size(), options,
+				 [&](int c) { return measure_cpu(M, N, K, candidates[c], isa, options, csv, result); },
+				 result.launches);
+	return result;
+}
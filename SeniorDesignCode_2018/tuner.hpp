@@ -0,0 +1,139 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: tuner.hpp
+//	Purpose of File: Header File for tuner.cpp
+//
+/****************************************************************************************/
+
+#ifndef TUNER
+#define TUNER
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "host.hpp"
+#include "batched.hpp"
+#include "cpu_sgemm.hpp"
+#include "search_space.hpp"
+#include "results.hpp"
+
+// How tune() picks the next configuration to launch
+enum SearchStrategy {
+	SEARCH_MODEL,		// random forest and expected improvement over enumerate_configs()
+	SEARCH_GENETIC,		// genetic algorithm over the points of a search space
+	SEARCH_ANNEALING	// simulated annealing over the points of a search space
+};
+
+// "model", "genetic" or "annealing"
+bool parse_strategy(const std::string& name, SearchStrategy& strategy);
+const char* strategy_name(const SearchStrategy strategy);
+
+// Time a configuration is ranked by
+enum TimeObjective {
+	OBJECTIVE_KERNEL,		// median kernel time
+	OBJECTIVE_END_TO_END	// host work, uploads, kernel and download (PhaseTimes)
+};
+
+// "kernel" or "total"
+bool parse_objective(const std::string& name, TimeObjective& objective);
+
+// Knobs of the model-guided search
+struct TunerOptions {
+	int 	initial_samples;	// random configurations measured before the model is used
+	int 	max_launches;		// hard budget of kernel launches
+	double 	min_gain;			// stop once the best expected improvement of log(time)
+								// falls below this (0.01 is about 1% of the best time)
+	int 	n_trees;			// size of the surrogate forest
+	int 	batch;				// matrices per launch, 1 for a single multiply
+	Transpose trans_a, trans_b;	// layout of a single multiply; each is tuned on its own
+	SearchStrategy strategy;
+	const SearchSpace* space;	// points of the genetic and annealing searches,
+								// NULL for default_search_space()
+	int 	population;			// genetic: configurations per generation
+	double 	mutation;			// genetic: chance each parameter of a child is perturbed
+	double 	temperature;		// annealing: starting tolerance for a slower move, in log(time)
+	double 	cooling;			// annealing: temperature factor after each move
+	double 	abort_factor;		// a configuration is dropped once it runs this many times
+								// slower than the best so far, 0 to run everything in full
+	double 	proxy_volume;		// M*N*K from which a run with K cut by proxy_divisor is
+	int 	proxy_divisor;		// timed first, scaled up and compared with the cutoff
+	TimeObjective objective;	// what best_time and the searches minimize
+	ResultsWriter* 	results;	// dataset every measurement is appended to, NULL for none
+	BenchmarkOptions bench;		// repetitions behind each measured time
+	VerifyOptions 	verify;		// check of each result, O(n^2) by default
+};
+
+TunerOptions default_tuner_options();
+
+// Outcome of one tuning run
+struct TunerResult {
+	KernelConfig 	best;
+	double 			best_time;		// ms, -1 when no configuration ran
+	double 			variant_time[3];	// fastest time of each LOCAL_MEM variant, or -1
+	// Kernel times of the same configurations, which the tuning database and the
+	// roofline compare whatever the objective; equal to the above for OBJECTIVE_KERNEL
+	double 			best_kernel_time;
+	double 			variant_kernel_time[3];
+	int 			launches;
+	int 			candidates;		// 0 when the strategy does not enumerate the space
+	int 			cached;			// configurations answered by the measure cache
+	int 			aborted;		// launches cut short by the cutoff or the K proxy
+	int 			skipped;		// configurations the model ruled out without a launch
+	std::vector<double> history;	// best time after each launch, -1 until one succeeds
+};
+
+// Times measured for one shape, layout and batch, keyed by the kernel build options.
+// Strategies given the same cache never launch a configuration twice.
+class MeasureCache {
+public:
+	// time is ranked by the objective; kernel_time is the kernel part of it
+	bool find(const KernelConfig& config, double& time, double* kernel_time = NULL) const;
+	void store(const KernelConfig& config, const double time, const double kernel_time);
+	int size() const 	{ return times.size(); }
+
+private:
+	std::map<std::string, std::pair<double, double> > times;
+};
+
+// Expected improvement over best for a prediction with the given mean and spread
+double expected_improvement(double best, double mean, double stddev);
+
+// Search for the fastest configuration on M x N x K with options.strategy. The model
+// search fits a random forest to the measurements so far and runs the candidate of
+// enumerate_configs() with the largest expected improvement; the genetic and annealing
+// searches walk the points of options.space. Every measurement is written to csv when
+// it is open, and configurations found in cache are not launched again. With
+// options.batch above 1 each launch multiplies that many matrices of the shape
+// (batched launches are NN only); otherwise it runs the layout of options.
+TunerResult tune(Session& session, const int M, const int N, const int K,
+				 const TunerOptions& options, std::ofstream& csv,
+				 MeasureCache* cache = NULL);
+
+// Outcome of one CPU tuning run
+struct CpuTunerResult {
+	CpuConfig 	best;
+	double 		best_time;		// ms, -1 when no configuration ran
+	int 		launches;
+	int 		candidates;
+};
+
+// The same search over the blocking and micro-tiles of cpu_sgemm() for the instruction
+// set; every measurement is written to csv (cpu_dataset.csv columns) when it is open
+CpuTunerResult tune_cpu(const int M, const int N, const int K, CpuIsa isa,
+						const TunerOptions& options, std::ofstream& csv);
+
+#endif
@@ -0,0 +1,315 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: tuning_db.cpp
+//	Function(s): TuningDB::load(), TuningDB::save(), TuningDB::record(),
+//				 TuningDB::lookup(), tuned_config(), run_sgemm_tuned(), sgemm(),
+//				 device_identity()
+//
+//	Purpose: 	Persistent database of tuned kernel configurations. Every tuning mode
+//				records the fastest configuration it measured for the device and shape,
+//				and later runs look the shape up instead of prompting or sweeping. When
+//				the shape was never tuned the nearest tuned shape of the same device is
+//				used, and without any entry for the device the random forest trained on
+//				the -g samples (kernel_dataset.csv unless the database is given another
+//				file) picks the configuration.
+//
+/****************************************************************************************/
+
+#include "tuning_db.hpp"
+
+#include <cstdio>
+#include <sstream>
+#include <unistd.h>
+
+const char* tuning_source_name(TuningSource source)
+{
+	switch (source){
+		case TUNED_EXACT: 	return "tuned";
+		case TUNED_NEAREST: return "nearest tuned shape";
+		case TUNED_MODEL: 	return "model prediction";
+		default: 			return "none";
+	}
+}
+
+std::string tuning_db_path()
+{
+	const char* path = getenv("OCLSGEMM_TUNING_DB");
+	if (path && path[0] != '\0')
+		return path;
+	return "tuning_db.csv";
+}
+
+std::string device_identity(cl_device_id device)
+{
+	const DeviceInfo* info = find_device(device);
+	if (info)
+		return info->identity;
+
+	char device_name[1024] = "";
+	char driver_version[1024] = "";
+	clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(device_name), device_name, NULL);
+	clGetDeviceInfo(device, CL_DRIVER_VERSION, sizeof(driver_version), driver_version, NULL);
+
+	// The identity is a CSV field, so it cannot hold commas
+	std::string identity = std::string(device_name) + " / " + driver_version;
+	for (size_t i = 0; i < identity.size(); i++){
+		if (identity[i] == ',' || identity[i] == '\n')
+			identity[i] = ';';
+	}
+	return identity;
+}
+
+static std::string shape_key(const std::string& device, const int M, const int N, const int K,
+							 const Transpose trans_a, const Transpose trans_b)
+{
+	std::stringstream key;
+	key << device << "|" << M << "x" << N << "x" << K << "|" << layout_name(trans_a, trans_b);
+	return key.str();
+}
+
+TuningDB::TuningDB(const std::string& path, const std::string& model_path)
+	: path(path), model_path(model_path), model_tried(false)
+{
+}
+
+bool TuningDB::load()
+{
+	entries.clear();
+	memo.clear();
+
+	std::ifstream csv(path.c_str());
+	if (!csv)
+		return false;
+
+	std::string line;
+	std::getline(csv, line);	// header
+	while (std::getline(csv, line)){
+		std::stringstream row(line);
+		std::string cell;
+		std::vector<std::string> cells;
+		while (std::getline(row, cell, ','))
+			cells.push_back(cell);
+		// Databases written before the Layout column hold NN entries only
+		TuningEntry entry;
+		entry.trans_a = NO_TRANS;
+		entry.trans_b = NO_TRANS;
+		if (cells.size() == 15){
+			if (!parse_layout(cells[4], entry.trans_a, entry.trans_b))
+				continue;
+			cells.erase(cells.begin() + 4);
+		}
+		if (cells.size() != 14)
+			continue;
+
+		entry.device 				= cells[0];
+		entry.M 					= atoi(cells[1].c_str());
+		entry.N 					= atoi(cells[2].c_str());
+		entry.K 					= atoi(cells[3].c_str());
+		entry.time 					= atof(cells[4].c_str());
+		entry.config.local_mem 		= atoi(cells[5].c_str());
+		entry.config.block_size 	= atoi(cells[6].c_str());
+		entry.config.tsm 			= atoi(cells[7].c_str());
+		entry.config.tsn 			= atoi(cells[8].c_str());
+		entry.config.tsk 			= atoi(cells[9].c_str());
+		entry.config.wptm 			= atoi(cells[10].c_str());
+		entry.config.wptn 			= atoi(cells[11].c_str());
+		entry.config.vector_width 	= atoi(cells[12].c_str());
+		entry.config.edge_guard 	= atoi(cells[13].c_str());
+		if (check_config(entry.config, 0))
+			entries.push_back(entry);
+	}
+	return true;
+}
+
+bool TuningDB::save() const
+{
+	// Write to a temporary file first so a crash never leaves a truncated database
+	char suffix[32];
+	sprintf(suffix, ".%d.tmp", (int) getpid());
+	std::string temp = path + suffix;
+	std::ofstream csv(temp.c_str());
+	if (!csv)
+		return false;
+
+	csv << "Device,M,N,K,Layout,Time,Local_Mem,Block_Size,TSM,TSN,TSK,WPTM,WPTN,Vector_Width,Edge_Guard\n";
+	for (size_t i = 0; i < entries.size(); i++){
+		const TuningEntry& e = entries[i];
+		csv << e.device << "," << e.M << "," << e.N << "," << e.K << ","
+			<< layout_name(e.trans_a, e.trans_b) << "," << e.time << ","
+			<< e.config.local_mem << "," << e.config.block_size << ","
+			<< e.config.tsm << "," << e.config.tsn << "," << e.config.tsk << ","
+			<< e.config.wptm << "," << e.config.wptn << ","
+			<< e.config.vector_width << "," << e.config.edge_guard << "\n";
+	}
+	csv.close();
+	if (!csv || rename(temp.c_str(), path.c_str()) != 0){
+		remove(temp.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool TuningDB::record(const std::string& device, const int M, const int N, const int K,
+					  const KernelConfig& config, const double time,
+					  const Transpose trans_a, const Transpose trans_b)
+{
+	if (time < 0)
+		return false;
+
+	int i = find(device, M, N, K, trans_a, trans_b);
+	if (i >= 0 && entries[i].time <= time)
+		return false;
+
+	TuningEntry entry;
+	entry.device = device;
+	entry.M = M;
+	entry.N = N;
+	entry.K = K;
+	entry.trans_a = trans_a;
+	entry.trans_b = trans_b;
+	entry.time = time;
+	entry.config = config;
+	if (i >= 0)
+		entries[i] = entry;
+	else
+		entries.push_back(entry);
+
+	// Nearest-shape answers may now point somewhere else
+	memo.clear();
+	return true;
+}
+
+int TuningDB::find(const std::string& device, const int M, const int N, const int K,
+				   const Transpose trans_a, const Transpose trans_b) const
+{
+	for (size_t i = 0; i < entries.size(); i++){
+		const TuningEntry& e = entries[i];
+		if (e.M == M && e.N == N && e.K == K && e.trans_a == trans_a && e.trans_b == trans_b &&
+			e.device == device)
+			return i;
+	}
+	return -1;
+}
+
+// Closest tuned shape of the device in the same layout, measured as the distance
+// between log sizes; the best tiles of one layout say little about another
+int TuningDB::nearest(const std::string& device, const int M, const int N, const int K,
+					  const Transpose trans_a, const Transpose trans_b) const
+{
+	int best = -1;
+	double best_distance = 0.0;
+	for (size_t i = 0; i < entries.size(); i++){
+		const TuningEntry& e = entries[i];
+		if (e.device != device || e.trans_a != trans_a || e.trans_b != trans_b)
+			continue;
+		double dm = log((double) e.M / M);
+		double dn = log((double) e.N / N);
+		double dk = log((double) e.K / K);
+		double distance = dm*dm + dn*dn + dk*dk;
+		if (best < 0 || distance < best_distance){
+			best = i;
+			best_distance = distance;
+		}
+	}
+	return best;
+}
+
+TuningSource TuningDB::lookup(const std::string& device, const int M, const int N, const int K,
+							  KernelConfig& config, const Transpose trans_a, const Transpose trans_b)
+{
+	if (M <= 0 || N <= 0 || K <= 0)
+		return TUNED_NONE;
+
+	std::string key = shape_key(device, M, N, K, trans_a, trans_b);
+	std::map<std::string, std::pair<TuningSource, KernelConfig> >::iterator found = memo.find(key);
+	if (found != memo.end()){
+		config = found->second.second;
+		return found->second.first;
+	}
+
+	TuningSource source = TUNED_NONE;
+	int i = find(device, M, N, K, trans_a, trans_b);
+	if (i >= 0){
+		source = TUNED_EXACT;
+		config = entries[i].config;
+	}
+	else if ((i = nearest(device, M, N, K, trans_a, trans_b)) >= 0){
+		source = TUNED_NEAREST;
+		config = entries[i].config;
+	}
+	else {
+		// Train the model once, on the first shape that needs it
+		if (!model_tried && !model_path.empty()){
+			model_tried = true;
+			std::vector<Sample> data_x;
+			std::vector<double> data_y;
+			std::vector<std::string> columns;
+			if (load_dataset(model_path, data_x, data_y, columns) && !data_x.empty() &&
+				columns.size() == config_features(M, N, K, make_config(1, 1)).size() + 1)
+				model.fit(data_x, data_y);
+		}
+		if (model.trained()){
+			const DeviceInfo* info = find_device(device);
+			std::vector<KernelConfig> candidates;
+			enumerate_configs(candidates, info);
+			double best_time = 0.0;
+			for (size_t c = 0; c < candidates.size(); c++){
+				double time = model.predict(config_features(M, N, K, candidates[c], info, 1, trans_a, trans_b));
+				if (c == 0 || time < best_time){
+					best_time = time;
+					config = candidates[c];
+				}
+			}
+			source = TUNED_MODEL;
+		}
+	}
+
+	memo[key] = std::make_pair(source, config);
+	return source;
+}
+
+KernelConfig tuned_config(TuningDB& db, cl_device_id device, const int M, const int N, const int K,
+						  const Transpose trans_a, const Transpose trans_b)
+{
+	KernelConfig config;
+	if (db.lookup(device_identity(device), M, N, K, config, trans_a, trans_b) == TUNED_NONE){
+		// Nothing tuned yet; the register-tiled kernel is a safe default
+		config = make_config(32, 32, 16, 4, 4);
+		config.edge_guard = 1;
+	}
+	return config;
+}
+
+double run_sgemm_tuned(Session& session, TuningDB& db,
+					   const int M, const int N, const int K,
+					   const float* A, const int lda,
+					   const float* B, const int ldb,
+					   float* C,       const int ldc)
+{
+	KernelConfig config = tuned_config(db, session.device(), M, N, K);
+	return run_sgemm(session, config, M, N, K, A, lda, B, ldb, C, ldc);
+}
+
+double sgemm(Session& session, TuningDB& db,
+			 const Transpose trans_a, const Transpose trans_b,
+			 const int M, const int N, const int K, const float alpha,
+			 const float* A, const int lda,
+			 const float* B, const int ldb, const float beta,
+			 float* C,       const int ldc)
+{
+	KernelConfig config = tuned_config(db, session.device(), M, N, K, trans_a, trans_b);
+	return run_sgemm(session, config, trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb,
+					 beta, C, ldc, NULL, NULL, 0);
+}
@@ -0,0 +1,112 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: tuning_db.hpp
+//	Purpose of File: Header File for tuning_db.cpp
+//
+/****************************************************************************************/
+
+#ifndef TUNING_DB
+#define TUNING_DB
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "host.hpp"
+#include "random_forest.hpp"
+
+// Best-known configuration of one device, problem shape and transpose layout
+struct TuningEntry {
+	std::string 	device;
+	int 			M, N, K;
+	Transpose 		trans_a, trans_b;
+	double 			time;		// ms
+	KernelConfig 	config;
+};
+
+// Where a looked-up configuration came from
+enum TuningSource { TUNED_NONE, TUNED_EXACT, TUNED_NEAREST, TUNED_MODEL };
+
+const char* tuning_source_name(TuningSource source);
+
+// Path of the database, OCLSGEMM_TUNING_DB or ./tuning_db.csv
+std::string tuning_db_path();
+
+// CL_DEVICE_NAME and CL_DRIVER_VERSION of the device, the key tuned results belong to
+std::string device_identity(cl_device_id device);
+
+// Tuned configurations keyed by device identity, M x N x K and layout, kept in a CSV
+// file. Files written before the layout column are read as NN.
+class TuningDB {
+public:
+	// model_path is the CSV (load_dataset()) lookup() trains its model on, "" for none
+	TuningDB(const std::string& path = tuning_db_path(),
+			 const std::string& model_path = "kernel_dataset.csv");
+
+	bool load();
+	bool save() const;
+
+	// Keep config for this device and shape when it beats the stored time
+	bool record(const std::string& device, const int M, const int N, const int K,
+				const KernelConfig& config, const double time,
+				const Transpose trans_a = NO_TRANS, const Transpose trans_b = NO_TRANS);
+
+	// Exact match, then the nearest tuned shape of the device in the same layout, then
+	// the best configuration predicted by a random forest trained on model_path
+	TuningSource lookup(const std::string& device, const int M, const int N, const int K,
+						KernelConfig& config,
+						const Transpose trans_a = NO_TRANS, const Transpose trans_b = NO_TRANS);
+
+	int size() const 	{ return (int) entries.size(); }
+
+private:
+	int find(const std::string& device, const int M, const int N, const int K,
+			 const Transpose trans_a, const Transpose trans_b) const;
+	int nearest(const std::string& device, const int M, const int N, const int K,
+				const Transpose trans_a, const Transpose trans_b) const;
+
+	std::string 				path;
+	std::string 				model_path;
+	std::vector<TuningEntry> 	entries;
+
+	// Answers already given for a device and shape, and the model behind TUNED_MODEL
+	std::map<std::string, std::pair<TuningSource, KernelConfig> > 	memo;
+	RandomForest 				model;
+	bool 						model_tried;
+};
+
+// Configuration lookup() finds for the device and shape, or a safe default
+KernelConfig tuned_config(TuningDB& db, cl_device_id device, const int M, const int N, const int K,
+						  const Transpose trans_a = NO_TRANS, const Transpose trans_b = NO_TRANS);
+
+// C = A * B with the tuned configuration of this shape; never prompts or sweeps
+double run_sgemm_tuned(Session& session, TuningDB& db,
+					   const int M, const int N, const int K,
+					   const float* A, const int lda,
+					   const float* B, const int ldb,
+					   float* C,       const int ldc);
+
+// BLAS-style C = alpha * op(A) * op(B) + beta * C with the tuned configuration of this
+// shape and layout. op(A) is M x K and op(B) is K x N; all matrices are row-major, and
+// a transposed operand is stored transposed (A as K x M, B as N x K). Returns the
+// kernel time in ms, -1 on failure.
+double sgemm(Session& session, TuningDB& db,
+			 const Transpose trans_a, const Transpose trans_b,
+			 const int M, const int N, const int K, const float alpha,
+			 const float* A, const int lda,
+			 const float* B, const int ldb, const float beta,
+			 float* C,       const int ldc);
+
+#endif
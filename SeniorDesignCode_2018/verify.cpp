@@ -0,0 +1,293 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: verify.cpp
+//	Function(s): reference_sgemm(), verify_sgemm(), default_verify_options(),
+//				 verify_mode_name()
+//
+//	Purpose: 	Checks the matrices the kernels return. The full check runs a cache
+//				blocked reference on every core, with inner loops the compiler can
+//				vectorize; the sampled and Freivalds checks cost O(n^2) so tuning
+//				sweeps are not dominated by verification. Kernels sum in a different
+//				order than the reference, so elements are compared against the
+//				rounding error bound of a float dot product instead of exactly.
+//
+/****************************************************************************************/
+
+#include "verify.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Cache blocks of the reference: a KB x NB panel of B stays in L2 while the rows
+// of A stream past it
+static const int MB = 16;
+static const int NB = 512;
+static const int KB = 128;
+
+VerifyOptions default_verify_options(VerifyMode mode)
+{
+	VerifyOptions options;
+	options.mode 		= mode;
+	options.samples 	= 8;
+	options.rounds 		= 2;
+	options.tolerance 	= 1.0;
+	options.threads 	= 0;
+	return options;
+}
+
+const char* verify_mode_name(VerifyMode mode)
+{
+	switch (mode){
+		case VERIFY_FULL: 		return "full";
+		case VERIFY_SAMPLED: 	return "sampled";
+		case VERIFY_FREIVALDS: 	return "Freivalds";
+		default: 				return "none";
+	}
+}
+
+// Rows [i0, i1) of C = A * B, and of S = |A| * |B| when absB is given
+static void multiply_rows(const int i0, const int i1, const int N, const int K,
+						  const float* A, const int lda,
+						  const float* B, const int ldb,
+						  float* C, const int ldc,
+						  const float* absB, float* S)
+{
+	for (int i = i0; i < i1; i++){
+		std::fill(C + (size_t) i*ldc, C + (size_t) i*ldc + N, 0.0f);
+		if (S)
+			std::fill(S + (size_t) (i - i0)*N, S + (size_t) (i - i0)*N + N, 0.0f);
+	}
+
+	for (int j0 = 0; j0 < N; j0 += NB){
+		int j1 = std::min(j0 + NB, N);
+		for (int k0 = 0; k0 < K; k0 += KB){
+			int k1 = std::min(k0 + KB, K);
+			for (int i = i0; i < i1; i++){
+				float* c = C + (size_t) i*ldc;
+				float* s = S ? S + (size_t) (i - i0)*N : NULL;
+				for (int k = k0; k < k1; k++){
+					const float a = A[(size_t) i*lda + k];
+					const float* b = B + (size_t) k*ldb;
+					for (int j = j0; j < j1; j++)
+						c[j] += a * b[j];
+					if (s){
+						const float abs_a = fabsf(a);
+						const float* abs_b = absB + (size_t) k*N;
+						for (int j = j0; j < j1; j++)
+							s[j] += abs_a * abs_b[j];
+					}
+				}
+			}
+		}
+	}
+}
+
+static int thread_count(int threads, int blocks)
+{
+	if (threads <= 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	return std::max(1, std::min(threads, blocks));
+}
+
+void reference_sgemm(const int M, const int N, const int K,
+					 const float* A, const int lda,
+					 const float* B, const int ldb,
+					 float* C, const int ldc, int threads)
+{
+	// Row blocks are handed out dynamically so uneven cores still finish together
+	int blocks = (M + MB - 1) / MB;
+	std::atomic<int> next(0);
+	std::vector<std::thread> workers;
+	for (int t = 0; t < thread_count(threads, blocks); t++){
+		workers.push_back(std::thread([&]() {
+			for (int b = next++; b < blocks; b = next++)
+				multiply_rows(b*MB, std::min(M, (b + 1)*MB), N, K, A, lda, B, ldb, C, ldc, NULL, NULL);
+		}));
+	}
+	for (size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+}
+
+// Error of one element as a fraction of its bound; > 1 fails, NaN fails
+static double element_error(double c, double r, double s, double bound_scale)
+{
+	double bound = bound_scale * s + FLT_MIN;
+	double error = fabs(c - r) / bound;
+	return error == error ? error : HUGE_VAL;
+}
+
+static void full_check(const VerifyOptions& options, const int M, const int N, const int K,
+					   const float* A, const int lda, const float* B, const int ldb,
+					   const float* C, const int ldc, const double bound_scale,
+					   VerifyResult& result)
+{
+	std::vector<float> absB((size_t) K * N);
+	for (int k = 0; k < K; k++){
+		for (int j = 0; j < N; j++)
+			absB[(size_t) k*N + j] = fabsf(B[(size_t) k*ldb + j]);
+	}
+
+	int blocks = (M + MB - 1) / MB;
+	int threads = thread_count(options.threads, blocks);
+	std::vector<double> worst(threads, 0.0);
+	std::atomic<int> next(0);
+	std::vector<std::thread> workers;
+	for (int t = 0; t < threads; t++){
+		workers.push_back(std::thread([&, t]() {
+			std::vector<float> ref((size_t) MB * N), sum((size_t) MB * N);
+			for (int b = next++; b < blocks; b = next++){
+				int i0 = b*MB, i1 = std::min(M, (b + 1)*MB);
+				// The reference rows go in a local buffer starting at row i0
+				multiply_rows(0, i1 - i0, N, K, A + (size_t) i0*lda, lda, B, ldb, &ref[0], N, &absB[0], &sum[0]);
+				for (int i = i0; i < i1; i++){
+					for (int j = 0; j < N; j++){
+						size_t r = (size_t) (i - i0)*N + j;
+						double e = element_error(C[(size_t) i*ldc + j], ref[r], sum[r], bound_scale);
+						worst[t] = std::max(worst[t], e);
+					}
+				}
+			}
+		}));
+	}
+	for (size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+
+	result.max_error = *std::max_element(worst.begin(), worst.end());
+	result.checked = (long long) M * N;
+}
+
+static void sampled_check(const VerifyOptions& options, const int M, const int N, const int K,
+						  const float* A, const int lda, const float* B, const int ldb,
+						  const float* C, const int ldc, const double bound_scale,
+						  std::mt19937& rng, VerifyResult& result)
+{
+	std::uniform_int_distribution<int> pick_row(0, M - 1), pick_col(0, N - 1);
+
+	// Every element of each sampled row and each sampled column, summed in double
+	for (int n = 0; n < options.samples; n++){
+		int i = pick_row(rng);
+		for (int j = 0; j < N; j++){
+			double r = 0.0, s = 0.0;
+			for (int k = 0; k < K; k++){
+				double p = (double) A[(size_t) i*lda + k] * B[(size_t) k*ldb + j];
+				r += p;
+				s += fabs(p);
+			}
+			result.max_error = std::max(result.max_error, element_error(C[(size_t) i*ldc + j], r, s, bound_scale));
+		}
+
+		int j = pick_col(rng);
+		for (int i = 0; i < M; i++){
+			double r = 0.0, s = 0.0;
+			for (int k = 0; k < K; k++){
+				double p = (double) A[(size_t) i*lda + k] * B[(size_t) k*ldb + j];
+				r += p;
+				s += fabs(p);
+			}
+			result.max_error = std::max(result.max_error, element_error(C[(size_t) i*ldc + j], r, s, bound_scale));
+		}
+		result.checked += M + N;
+	}
+}
+
+static void freivalds_check(const VerifyOptions& options, const int M, const int N, const int K,
+							const float* A, const int lda, const float* B, const int ldb,
+							const float* C, const int ldc, const double bound_scale,
+							std::mt19937& rng, VerifyResult& result)
+{
+	std::bernoulli_distribution coin(0.5);
+	std::vector<double> x(N), y(K), max_b(K);
+
+	// Largest |b_kj| of each row of B, so max_j s_ij <= sum_k |a_ik| max_b[k]
+	for (int k = 0; k < K; k++){
+		double m = 0.0;
+		for (int j = 0; j < N; j++)
+			m = std::max(m, (double) fabsf(B[(size_t) k*ldb + j]));
+		max_b[k] = m;
+	}
+
+	// The element errors e_ij of a row are independent of the random signs, so
+	// |sum_j e_ij x_j| stays below 6 sqrt(N) max_j |e_ij| but with probability
+	// 2 exp(-18) (Hoeffding). That is 3 sqrt(N) max_j s_ij in units of bound_scale.
+	const double spread = 3.0 * sqrt((double) N);
+
+	for (int round = 0; round < options.rounds; round++){
+		for (int j = 0; j < N; j++)
+			x[j] = coin(rng) ? 1.0 : -1.0;
+
+		// y = B x
+		for (int k = 0; k < K; k++){
+			double v = 0.0;
+			for (int j = 0; j < N; j++)
+				v += B[(size_t) k*ldb + j] * x[j];
+			y[k] = v;
+		}
+
+		// Row i of C x against row i of A y
+		for (int i = 0; i < M; i++){
+			double cx = 0.0, ay = 0.0, s = 0.0;
+			for (int j = 0; j < N; j++)
+				cx += C[(size_t) i*ldc + j] * x[j];
+			for (int k = 0; k < K; k++){
+				ay += A[(size_t) i*lda + k] * y[k];
+				s += fabs(A[(size_t) i*lda + k]) * max_b[k];
+			}
+			result.max_error = std::max(result.max_error, element_error(cx, ay, spread * s, bound_scale));
+		}
+		result.checked += M;
+	}
+}
+
+VerifyResult verify_sgemm(const VerifyOptions& options, const int M, const int N, const int K,
+						  const float* A, const int lda,
+						  const float* B, const int ldb,
+						  const float* C, const int ldc)
+{
+	VerifyResult result;
+	result.passed = true;
+	result.max_error = 0.0;
+	result.checked = 0;
+	result.ms = 0.0;
+	if (options.mode == VERIFY_NONE || M <= 0 || N <= 0 || K <= 0)
+		return result;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	// The kernel and the reference each lie within K * eps/2 * s of the exact product,
+	// whatever order they sum in
+	double bound_scale = options.tolerance * K * FLT_EPSILON;
+
+	// A different draw on every call so a sweep covers different rows and columns; checks
+	// run on several threads at once
+	static std::atomic<unsigned int> calls(0);
+	std::mt19937 rng(2018 + calls++);
+
+	if (options.mode == VERIFY_FULL)
+		full_check(options, M, N, K, A, lda, B, ldb, C, ldc, bound_scale, result);
+	else if (options.mode == VERIFY_SAMPLED)
+		sampled_check(options, M, N, K, A, lda, B, ldb, C, ldc, bound_scale, rng, result);
+	else
+		freivalds_check(options, M, N, K, A, lda, B, ldb, C, ldc, bound_scale, rng, result);
+
+	result.passed = result.max_error <= 1.0;
+	result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
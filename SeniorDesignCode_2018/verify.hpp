@@ -0,0 +1,63 @@
+/****************************************************************************************/
+//
+//	Adaptive Auto Tuning of Computations on Heterogeneous Environments
+//
+//	University of New Mexico
+//	Department of Electrical and Computer Engineering
+//	Melissa Castillo and Christian Curley
+//
+//	Sponsor and Technical Mentor: Carlos Reyes - Stellar Science
+//
+// ---------------------------------------------------------------------------------------
+//
+//	Last Update: October 17th, 2026
+//
+//	File Name: verify.hpp
+//	Purpose of File: Header File for verify.cpp
+//
+/****************************************************************************************/
+
+#ifndef VERIFY
+#define VERIFY
+
+// How the result of a kernel is checked
+enum VerifyMode {
+	VERIFY_NONE,		// no check
+	VERIFY_FULL,		// every element against the blocked multithreaded reference, O(n^3)
+	VERIFY_SAMPLED,		// every element of a few random rows and columns, O(n^2)
+	VERIFY_FREIVALDS	// C x == A (B x) for random sign vectors x, O(n^2)
+};
+
+struct VerifyOptions {
+	VerifyMode 	mode;
+	int 		samples;	// rows and columns checked by VERIFY_SAMPLED
+	int 		rounds;		// random vectors tried by VERIFY_FREIVALDS
+	double 		tolerance;	// multiple of the float rounding bound an element may be off
+	int 		threads;	// reference threads, 0 = every core
+};
+
+VerifyOptions default_verify_options(VerifyMode mode = VERIFY_FULL);
+const char* verify_mode_name(VerifyMode mode);
+
+struct VerifyResult {
+	bool 		passed;
+	double 		max_error;	// largest error as a fraction of its allowed bound
+	long long 	checked;	// elements (or vector entries) compared
+	double 		ms;			// wall time of the check
+};
+
+// C = A * B on the CPU, cache blocked and split across threads; row-major with
+// leading dimensions, A (M x K), B (K x N), C (M x N)
+void reference_sgemm(const int M, const int N, const int K,
+					 const float* A, const int lda,
+					 const float* B, const int ldb,
+					 float* C, const int ldc, int threads = 0);
+
+// Check C against A * B. An element passes when |c - r| <= tolerance * K * eps * s,
+// with s = sum_k |a_ik| |b_kj|, the forward error bound of a float dot product.
+VerifyResult verify_sgemm(const VerifyOptions& options, const int M, const int N, const int K,
+						  const float* A, const int lda,
+						  const float* B, const int ldb,
+						  const float* C, const int ldc);
+
+#endif